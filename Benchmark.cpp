@@ -0,0 +1,1398 @@
+#include "SimpleEQAudioProcessor.h"
+#include "ParameterTable.h"
+#include "PresetBank.h"
+#include "ResponseCurve.h"
+#include "FrequencyResponse.h"
+#include "LinearPhaseEQ.h"
+#include "SIMDBiquadCascade.h"
+#include "RealtimeChecks.h"
+
+#include <complex>
+#include <iostream>
+#include <thread>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+// Benchmarks of the DSP hot path, printed as JSON:
+//
+//   SimpleEQBenchmark [--output <file>]
+//
+// Every result is the median over many runs of the CPU cycles (or high resolution ticks, see
+// "counter" in the context) one run took, plus the same per sample where that makes sense.
+//
+//   SimpleEQBenchmark --realtime-check
+//
+// instead sweeps automation through processBlock and exits with 1 if anything in it allocated or
+// locked a mutex. Needs a build with SIMPLEEQ_REALTIME_CHECKS.
+//
+//   SimpleEQBenchmark --check
+//
+// instead checks what the benchmarks take for granted - that the processor behaves as it tells
+// the host it does - and exits with 1 if anything doesn't.
+
+struct ProcessorBenchmarkAccess {
+    static void updateFilters(SimpleEQAudioProcessor& processor) { processor.updateFilters(); }
+    static PresetBank& getPresetBank(SimpleEQAudioProcessor& processor) { return *processor.presetBank; }
+    // Whether the last program switch went to the program's ready made coefficients
+    static bool isUsingProgramCoefficients(const SimpleEQAudioProcessor& processor) { return processor.programSettings.has_value(); }
+};
+
+// CPU cycles where the timestamp counter is available, high resolution ticks everywhere else
+static juce::uint64 readCycleCounter() noexcept {
+#if JUCE_INTEL
+    return static_cast<juce::uint64>(__rdtsc());
+#else
+    return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+#endif
+}
+
+static juce::String getCounterName() {
+#if JUCE_INTEL
+    return "tsc";
+#else
+    return "high_resolution_ticks";
+#endif
+}
+
+// Calls setup() untimed before every run, times process() alone and returns the median
+template<typename SetupFunction, typename ProcessFunction>
+static double measureMedianCycles(int numRuns, SetupFunction&& setup, ProcessFunction&& process) {
+    std::vector<juce::uint64> cycles;
+    cycles.reserve(static_cast<size_t>(numRuns));
+
+    for (int run = 0; run < numRuns; ++run) {
+        setup();
+
+        auto start = readCycleCounter();
+        process();
+        cycles.push_back(readCycleCounter() - start);
+    }
+
+    std::sort(cycles.begin(), cycles.end());
+    return static_cast<double>(cycles[cycles.size() / 2]);
+}
+
+// Refills the buffer with the same noise before every run
+template<typename SampleType, typename ProcessFunction>
+static double measureMedianCycles(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& source,
+                                  int numRuns, ProcessFunction&& process) {
+    return measureMedianCycles(numRuns, [&] { buffer.makeCopyOf(source, true); }, process);
+}
+
+// Enough runs for a stable median without the large blocks taking forever
+static int getNumRuns(int samplesPerRun) {
+    return juce::jlimit(20, 2000, (1 << 18) / samplesPerRun);
+}
+
+static juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples) {
+    juce::Random random(1234);
+    juce::AudioBuffer<float> noise(numChannels, numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        for (int i = 0; i < numSamples; ++i) {
+            noise.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+        }
+    }
+
+    return noise;
+}
+
+static int getSlopeInDecibels(Slope slope) {
+    return 12 * (static_cast<int>(slope) + 1);
+}
+
+static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value) {
+    auto* parameter = processor.apvts.getParameter(parameterID);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Every band active, so nothing is skipped
+static void setActiveSettings(SimpleEQAudioProcessor& processor) {
+    setParameter(processor, "LowCut Freq", 80.f);
+    setParameter(processor, "HighCut Freq", 12000.f);
+    setParameter(processor, "Peak Freq", 1000.f);
+    setParameter(processor, "Peak Gain", 6.f);
+    setParameter(processor, "Peak Quality", 1.f);
+}
+
+// Sets each parameter to its value, then prepares the processor for stereo blocks of up to
+// blockSize at sampleRate - again if it already was, as some parameters are only read there
+static void prepareProcessor(SimpleEQAudioProcessor& processor, double sampleRate, int blockSize,
+                             const std::vector<std::pair<juce::String, float>>& values = {}) {
+    for (const auto& [parameterID, value] : values) {
+        setParameter(processor, parameterID, value);
+    }
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+// Runs signal through processBlock() in place, blockSize samples at a time as a host would
+static void processInBlocks(SimpleEQAudioProcessor& processor, juce::AudioBuffer<float>& signal, int blockSize) {
+    juce::AudioBuffer<float> block;
+    juce::MidiBuffer midiMessages;
+
+    for (int start = 0; start < signal.getNumSamples(); start += blockSize) {
+        auto numSamples = juce::jmin(blockSize, signal.getNumSamples() - start);
+        block.setSize(signal.getNumChannels(), numSamples, false, false, true);
+
+        for (int channel = 0; channel < signal.getNumChannels(); ++channel) {
+            block.copyFrom(channel, 0, signal, channel, start, numSamples);
+        }
+
+        processor.processBlock(block, midiMessages);
+
+        for (int channel = 0; channel < signal.getNumChannels(); ++channel) {
+            signal.copyFrom(channel, start, block, channel, 0, numSamples);
+        }
+    }
+}
+
+// One way of running the processor for a check to cover - its name in failures, and the one
+// parameter that sets it apart from the others
+struct ProcessorVariant {
+    const char* name;
+    const char* parameterID;
+    float value;
+};
+
+// What the checks prepare their processors for
+static constexpr double checkSampleRate = 48000.0;
+static constexpr int checkBlockSize = 512;
+
+// Runs check(processor, name) on a new processor for each variant - every band active, the
+// variant's parameter and then values set, and offline so the settings are in from the first
+// block. Returns whether it held for all of them.
+template<typename Check>
+static bool checkVariants(std::initializer_list<ProcessorVariant> variants,
+                          const std::vector<std::pair<juce::String, float>>& values, Check&& check) {
+    auto passed = true;
+
+    for (const auto& variant : variants) {
+        std::vector<std::pair<juce::String, float>> variantValues {{variant.parameterID, variant.value}};
+        variantValues.insert(variantValues.end(), values.begin(), values.end());
+
+        SimpleEQAudioProcessor processor;
+        setActiveSettings(processor);
+        processor.setNonRealtime(true);
+        prepareProcessor(processor, checkSampleRate, checkBlockSize, variantValues);
+
+        passed &= check(processor, juce::String(variant.name));
+    }
+
+    return passed;
+}
+
+static ChainSettings makeActiveChainSettings() {
+    ChainSettings chainSettings;
+    chainSettings.lowCutFreq = 80.f;
+    chainSettings.highCutFreq = 12000.f;
+    chainSettings.peaks[0].freq = 1000.f;
+    chainSettings.peaks[0].gainInDecibels = 6.f;
+    chainSettings.peaks[0].quality = 1.f;
+
+    // The other bands are flat, but still need somewhere valid to sit
+    for (size_t band = 1; band < numPeakBands; ++band) {
+        chainSettings.peaks[band].freq = 1000.f;
+    }
+
+    chainSettings.lowCutSlope = Slope_48;
+    chainSettings.highCutSlope = Slope_48;
+    return chainSettings;
+}
+
+static juce::DynamicObject::Ptr makeResult(const juce::String& name, double medianCycles, int numRuns) {
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("name", name);
+    result->setProperty("runs", numRuns);
+    result->setProperty("median_cycles", medianCycles);
+    return result;
+}
+
+// Times processBlock() on source, calling setup() untimed before every run, and returns the
+// result with the rate and cost per sample filled in
+template<typename SetupFunction>
+static juce::DynamicObject::Ptr measureProcessBlock(SimpleEQAudioProcessor& processor, const juce::String& name,
+                                                    const juce::AudioBuffer<float>& source, SetupFunction&& setup) {
+    auto blockSize = source.getNumSamples();
+    juce::AudioBuffer<float> buffer(source.getNumChannels(), blockSize);
+    juce::MidiBuffer midiMessages;
+    auto numRuns = getNumRuns(blockSize);
+
+    auto cycles = measureMedianCycles(numRuns, [&] {
+        buffer.makeCopyOf(source, true);
+        setup();
+    }, [&] {
+        processor.processBlock(buffer, midiMessages);
+    });
+
+    auto result = makeResult(name, cycles, numRuns);
+    result->setProperty("sample_rate", processor.getSampleRate());
+    result->setProperty("cycles_per_sample", cycles / blockSize);
+    return result;
+}
+
+static juce::DynamicObject::Ptr measureProcessBlock(SimpleEQAudioProcessor& processor, const juce::String& name,
+                                                    const juce::AudioBuffer<float>& source) {
+    return measureProcessBlock(processor, name, source, [] {});
+}
+
+// Compares the old per-channel MonoChain path with SIMDBiquadCascade for a stereo buffer,
+// with every section of the cascade active
+static void benchmarkStereoCascade(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+
+    ChainCoefficients coefficients;
+    updateChainCoefficients(coefficients, makeActiveChainSettings(), sampleRate);
+
+    for (int blockSize : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096}) {
+        auto source = makeNoise(numChannels, blockSize);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        auto numRuns = getNumRuns(blockSize);
+
+        juce::dsp::ProcessSpec monoSpec {sampleRate, static_cast<juce::uint32>(blockSize), 1};
+        MonoChain leftChain, rightChain;
+
+        for (auto* chain : {&leftChain, &rightChain}) {
+            reserveCoefficientStorage(*chain);
+            chain->prepare(monoSpec);
+            applyChainCoefficients(*chain, coefficients);
+        }
+
+        SIMDBiquadCascade cascade;
+        cascade.prepare({sampleRate, static_cast<juce::uint32>(blockSize), numChannels});
+        cascade.setCoefficients(coefficients);
+
+        juce::ScopedNoDenormals noDenormals;
+
+        auto monoChainCycles = measureMedianCycles(buffer, source, numRuns, [&] {
+            juce::dsp::AudioBlock<float> block(buffer);
+            auto leftBlock = block.getSingleChannelBlock(0);
+            auto rightBlock = block.getSingleChannelBlock(1);
+
+            leftChain.process(juce::dsp::ProcessContextReplacing<float>(leftBlock));
+            rightChain.process(juce::dsp::ProcessContextReplacing<float>(rightBlock));
+        });
+
+        auto cascadeCycles = measureMedianCycles(buffer, source, numRuns, [&] {
+            cascade.process(juce::dsp::AudioBlock<float>(buffer));
+        });
+
+        for (auto [engine, cycles] : {std::pair<const char*, double> {"mono_chains", monoChainCycles},
+                                      std::pair<const char*, double> {"simd_cascade", cascadeCycles}}) {
+            auto result = makeResult(juce::String("cascade/") + engine + "/" + juce::String(blockSize), cycles, numRuns);
+            result->setProperty("block_size", blockSize);
+            result->setProperty("cycles_per_sample", cycles / blockSize);
+            results.add(result.get());
+        }
+    }
+}
+
+// SIMDBiquadCascade across channel layouts from mono to a 7.1.4 bed and third-order ambisonics,
+// with every section active, at a typical block size
+static void benchmarkChannelCounts(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    ChainCoefficients coefficients;
+    updateChainCoefficients(coefficients, makeActiveChainSettings(), sampleRate);
+
+    for (int numChannels : {1, 2, 4, 6, 8, 12, 16}) {
+        auto source = makeNoise(numChannels, blockSize);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        auto numRuns = getNumRuns(blockSize * numChannels);
+
+        SIMDBiquadCascade cascade;
+        cascade.prepare({sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+        cascade.setCoefficients(coefficients);
+
+        juce::ScopedNoDenormals noDenormals;
+
+        auto cycles = measureMedianCycles(buffer, source, numRuns, [&] {
+            cascade.process(juce::dsp::AudioBlock<float>(buffer));
+        });
+
+        auto result = makeResult("channels/" + juce::String(numChannels), cycles, numRuns);
+        result->setProperty("channels", numChannels);
+        result->setProperty("block_size", blockSize);
+        result->setProperty("cycles_per_channel_sample", cycles / (blockSize * numChannels));
+        results.add(result.get());
+    }
+}
+
+struct PrecisionResult {
+    double medianCycles;
+    int numRuns;
+    // The first channel's output over numBlocks blocks of noise, fed continuously
+    std::vector<double> output;
+};
+
+// The first channel's output of a cascade in SampleType precision, over numBlocks blocks of noise
+// fed continuously
+template<typename SampleType>
+static std::vector<double> runCascade(SIMDBiquadCascade& cascade, const juce::AudioBuffer<float>& noise, int numBlocks) {
+    auto blockSize = noise.getNumSamples();
+
+    juce::AudioBuffer<SampleType> buffer;
+    std::vector<double> output;
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int block = 0; block < numBlocks; ++block) {
+        buffer.makeCopyOf(noise, true);
+        cascade.process(juce::dsp::AudioBlock<SampleType>(buffer));
+        output.insert(output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize);
+    }
+
+    return output;
+}
+
+// The power of measured's difference from reference, relative to reference's own
+static double getErrorDecibels(const std::vector<double>& measured, const std::vector<double>& reference) {
+    double errorPower = 0.0, referencePower = 0.0;
+
+    for (size_t i = 0; i < reference.size(); ++i) {
+        errorPower += juce::square(measured[i] - reference[i]);
+        referencePower += juce::square(reference[i]);
+    }
+
+    // Compared with itself, the reference has no error to speak of
+    return errorPower > 0.0 ? 10.0 * std::log10(errorPower / referencePower) : -300.0;
+}
+
+template<typename SampleType>
+static PrecisionResult measureCascadePrecision(const ChainCoefficients& coefficients, FilterTopology topology,
+                                               const juce::AudioBuffer<float>& noise, int numBlocks) {
+    auto numChannels = noise.getNumChannels();
+    auto blockSize = noise.getNumSamples();
+
+    juce::AudioBuffer<SampleType> source, buffer(numChannels, blockSize);
+    source.makeCopyOf(noise);
+
+    SIMDBiquadCascade cascade;
+    cascade.prepare({coefficients.sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels)});
+    cascade.setTopology(topology);
+    cascade.setCoefficients(coefficients);
+
+    juce::ScopedNoDenormals noDenormals;
+
+    PrecisionResult result;
+    result.numRuns = getNumRuns(blockSize);
+    result.medianCycles = measureMedianCycles(buffer, source, result.numRuns, [&] {
+        cascade.process(juce::dsp::AudioBlock<SampleType>(buffer));
+    });
+
+    cascade.reset();
+    result.output = runCascade<SampleType>(cascade, noise, numBlocks);
+    return result;
+}
+
+// SIMDBiquadCascade in single and double precision, running biquads or state variable filters, with
+// a 20 Hz 48 dB/oct low cut - where biquads in single precision fall apart at high sample rates.
+// Alongside the cost, "error_db" is each engine's error against double precision biquads, relative
+// to their output, over a second of audio.
+static void benchmarkPrecision(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+
+    auto noise = makeNoise(numChannels, blockSize);
+
+    for (double sampleRate : {48000.0, 192000.0}) {
+        auto chainSettings = makeActiveChainSettings();
+        chainSettings.lowCutFreq = 20.f;
+
+        ChainCoefficients coefficients;
+        updateChainCoefficients(coefficients, chainSettings, sampleRate);
+
+        auto numBlocks = static_cast<int>(sampleRate) / blockSize;
+        auto reference = measureCascadePrecision<double>(coefficients, FilterTopology_Biquad, noise, numBlocks).output;
+
+        for (auto topology : {FilterTopology_Biquad, FilterTopology_StateVariable}) {
+            for (auto doublePrecision : {false, true}) {
+                auto measured = doublePrecision
+                              ? measureCascadePrecision<double>(coefficients, topology, noise, numBlocks)
+                              : measureCascadePrecision<float>(coefficients, topology, noise, numBlocks);
+
+                auto name = "precision/" + juce::String(static_cast<int>(sampleRate)) + "/"
+                          + (topology == FilterTopology_StateVariable ? "svf" : "biquad") + "/"
+                          + (doublePrecision ? "double" : "float");
+
+                auto result = makeResult(name, measured.medianCycles, measured.numRuns);
+                result->setProperty("sample_rate", sampleRate);
+                result->setProperty("cycles_per_sample", measured.medianCycles / blockSize);
+                result->setProperty("error_db", getErrorDecibels(measured.output, reference));
+                results.add(result.get());
+            }
+        }
+    }
+}
+
+// LinearPhaseEQ, stereo, at sample rates whose kernels range from 8192 to 32768 taps
+static void benchmarkLinearPhase(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = LinearPhaseEQ::partitionSize;
+
+    for (double sampleRate : {44100.0, 48000.0, 96000.0, 192000.0}) {
+        ChainCoefficients coefficients;
+        updateChainCoefficients(coefficients, makeActiveChainSettings(), sampleRate);
+
+        LinearPhaseEQ linearPhaseEQ;
+        linearPhaseEQ.prepare({sampleRate, static_cast<juce::uint32>(blockSize), numChannels}, coefficients);
+
+        auto source = makeNoise(numChannels, blockSize);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        auto numRuns = getNumRuns(blockSize);
+
+        juce::ScopedNoDenormals noDenormals;
+
+        auto cycles = measureMedianCycles(buffer, source, numRuns, [&] {
+            linearPhaseEQ.process(juce::dsp::AudioBlock<float>(buffer));
+        });
+
+        auto result = makeResult("linearPhase/" + juce::String(static_cast<int>(sampleRate)), cycles, numRuns);
+        result->setProperty("sample_rate", sampleRate);
+        result->setProperty("latency", linearPhaseEQ.getLatencySamples());
+        result->setProperty("cycles_per_sample", cycles / blockSize);
+        results.add(result.get());
+    }
+}
+
+// The whole processBlock, stereo, for every combination of sample rate, block size and slopes
+static void benchmarkProcessBlock(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int maxBlockSize = 4096;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+
+    auto source = makeNoise(numChannels, maxBlockSize);
+
+    for (double sampleRate : {44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0}) {
+        for (auto lowCutSlope : {Slope_12, Slope_24, Slope_36, Slope_48}) {
+            for (auto highCutSlope : {Slope_12, Slope_24, Slope_36, Slope_48}) {
+                prepareProcessor(processor, sampleRate, maxBlockSize, {{"LowCut Slope", static_cast<float>(lowCutSlope)},
+                                                                       {"HighCut Slope", static_cast<float>(highCutSlope)}});
+
+                for (int blockSize : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096}) {
+                    juce::AudioBuffer<float> blockSource(source.getArrayOfWritePointers(), numChannels, blockSize);
+
+                    auto name = "processBlock/" + juce::String(static_cast<int>(sampleRate)) + "/"
+                              + juce::String(blockSize) + "/" + juce::String(getSlopeInDecibels(lowCutSlope)) + "/"
+                              + juce::String(getSlopeInDecibels(highCutSlope));
+
+                    auto result = measureProcessBlock(processor, name, blockSource);
+                    result->setProperty("block_size", blockSize);
+                    result->setProperty("low_cut_slope", getSlopeInDecibels(lowCutSlope));
+                    result->setProperty("high_cut_slope", getSlopeInDecibels(highCutSlope));
+                    results.add(result.get());
+                }
+
+                processor.releaseResources();
+            }
+        }
+    }
+}
+
+// The whole processBlock, stereo, with the cascade oversampled 1x, 2x and 4x, against matched
+// designs at the host rate, which cost no more than bilinear ones
+static void benchmarkOversampling(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+    setParameter(processor, "LowCut Slope", static_cast<float>(Slope_48));
+    setParameter(processor, "HighCut Slope", static_cast<float>(Slope_48));
+
+    auto source = makeNoise(numChannels, blockSize);
+
+    for (double sampleRate : {44100.0, 48000.0}) {
+        for (auto filterDesign : {FilterDesign_Bilinear, FilterDesign_Matched}) {
+            for (int factorLog2 = 0; factorLog2 <= 2; ++factorLog2) {
+                prepareProcessor(processor, sampleRate, blockSize, {{"Filter Design", static_cast<float>(filterDesign)},
+                                                                    {"Oversampling", static_cast<float>(factorLog2)}});
+
+                auto factor = 1 << factorLog2;
+                auto name = "oversampling/" + juce::String(static_cast<int>(sampleRate)) + "/"
+                          + (filterDesign == FilterDesign_Matched ? "matched" : "bilinear") + "/"
+                          + juce::String(factor) + "x";
+
+                auto result = measureProcessBlock(processor, name, source);
+                result->setProperty("oversampling", factor);
+                result->setProperty("latency", processor.getLatencySamples());
+                results.add(result.get());
+
+                processor.releaseResources();
+            }
+        }
+    }
+}
+
+// The whole processBlock, stereo, on silence - once the filters have rung out it's skipped, so
+// this is the cost of detecting silence, against the same settings on noise
+static void benchmarkSilence(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+    prepareProcessor(processor, sampleRate, blockSize);
+
+    juce::AudioBuffer<float> silence(numChannels, blockSize);
+    silence.clear();
+
+    for (auto isSilence : {false, true}) {
+        auto source = isSilence ? silence : makeNoise(numChannels, blockSize);
+
+        // Long enough for every tail to have decayed before timing starts
+        auto warmUpBlocks = static_cast<int>(std::ceil(processor.getTailLengthSeconds() * sampleRate / blockSize)) + 1;
+
+        for (int i = 0; i < warmUpBlocks; ++i) {
+            auto buffer = source;
+            processInBlocks(processor, buffer, blockSize);
+        }
+
+        auto result = measureProcessBlock(processor, juce::String("silence/") + (isSilence ? "silence" : "noise"), source);
+        result->setProperty("tail_seconds", processor.getTailLengthSeconds());
+        results.add(result.get());
+    }
+
+    processor.releaseResources();
+}
+
+// The whole processBlock, stereo, with each band bypassed in turn and then the whole plugin -
+// a bypassed band should cost nothing once it has ramped out
+static void benchmarkBypass(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+    setParameter(processor, "LowCut Slope", static_cast<float>(Slope_48));
+    setParameter(processor, "HighCut Slope", static_cast<float>(Slope_48));
+
+    auto source = makeNoise(numChannels, blockSize);
+
+    const std::array<std::pair<const char*, const char*>, 5> cases {{{"none", ""},
+                                                                    {"lowcut", "LowCut Bypassed"},
+                                                                    {"peak", "Peak Bypassed"},
+                                                                    {"highcut", "HighCut Bypassed"},
+                                                                    {"all", "Bypass"}}};
+
+    for (const auto& [name, bypassedID] : cases) {
+        std::vector<std::pair<juce::String, float>> bypasses;
+
+        for (auto* parameterID : {"LowCut Bypassed", "Peak Bypassed", "HighCut Bypassed", "Bypass"}) {
+            bypasses.emplace_back(parameterID, juce::String(bypassedID) == parameterID ? 1.f : 0.f);
+        }
+
+        prepareProcessor(processor, sampleRate, blockSize, bypasses);
+        results.add(measureProcessBlock(processor, juce::String("bypass/") + name, source).get());
+
+        processor.releaseResources();
+    }
+}
+
+// The whole processBlock, stereo, with more and more of the parametric bands boosting - flat
+// bands are left out of the cascade, so the cost should follow the number that aren't
+static void benchmarkPeakBands(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+
+    auto source = makeNoise(numChannels, blockSize);
+    const auto& peakParameterIDs = getPeakParameterIDs();
+
+    for (int numActiveBands : {0, 1, 2, 4, 8, 16}) {
+        std::vector<std::pair<juce::String, float>> gains;
+
+        for (size_t band = 0; band < numPeakBands; ++band) {
+            gains.emplace_back(peakParameterIDs[band].gain, static_cast<int>(band) < numActiveBands ? 6.f : 0.f);
+        }
+
+        prepareProcessor(processor, sampleRate, blockSize, gains);
+
+        auto result = measureProcessBlock(processor, "peakBands/" + juce::String(numActiveBands), source);
+        result->setProperty("active_bands", numActiveBands);
+        results.add(result.get());
+
+        processor.releaseResources();
+    }
+}
+
+// An offline render's processBlock with a large block, with nothing automated and with every
+// band moving before each block - each block is split into sub-blocks that check for changes,
+// and the first of them redesigns inline
+static void benchmarkAutomation(juce::Array<juce::var>& results) {
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 2048;
+    constexpr double sampleRate = 48000.0;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+    processor.setNonRealtime(true);
+    prepareProcessor(processor, sampleRate, blockSize);
+
+    auto source = makeNoise(numChannels, blockSize);
+    auto flip = false;
+
+    for (auto automated : {false, true}) {
+        auto name = juce::String("automation/offline/") + (automated ? "every_block" : "none");
+
+        auto result = measureProcessBlock(processor, name, source, [&] {
+            if (automated) {
+                flip = !flip;
+                setParameter(processor, "LowCut Freq", flip ? 80.f : 90.f);
+                setParameter(processor, "HighCut Freq", flip ? 12000.f : 11000.f);
+                setParameter(processor, "Peak Freq", flip ? 1000.f : 1100.f);
+                setParameter(processor, "Peak Gain", flip ? 6.f : 5.f);
+            }
+        });
+
+        result->setProperty("block_size", blockSize);
+        results.add(result.get());
+    }
+
+    processor.releaseResources();
+}
+
+// updateFilters() when nothing changed, both ways it gets its coefficients, and when offline
+// rendering has to redesign every band. The cheap cases are timed in batches.
+static void benchmarkUpdateFilters(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int callsPerRun = 100;
+    constexpr int numRuns = 2000;
+
+    SimpleEQAudioProcessor processor;
+    setActiveSettings(processor);
+    prepareProcessor(processor, sampleRate, blockSize, {{"LowCut Slope", static_cast<float>(Slope_48)},
+                                                        {"HighCut Slope", static_cast<float>(Slope_48)}});
+
+    auto addBatchResult = [&results](const juce::String& name, double cycles) {
+        auto result = makeResult(name, cycles / callsPerRun, numRuns);
+        result->setProperty("calls_per_run", callsPerRun);
+        results.add(result.get());
+    };
+
+    auto callBatch = [&processor] {
+        for (int i = 0; i < callsPerRun; ++i) {
+            ProcessorBenchmarkAccess::updateFilters(processor);
+        }
+    };
+
+    addBatchResult("updateFilters/realtime_unchanged", measureMedianCycles(numRuns, [] {}, callBatch));
+
+    // Without the designer thread, which would otherwise pick up every parameter change below
+    processor.releaseResources();
+    processor.setNonRealtime(true);
+
+    addBatchResult("updateFilters/offline_unchanged", measureMedianCycles(numRuns, [] {}, callBatch));
+
+    auto flip = false;
+    auto changeEveryBand = [&] {
+        flip = !flip;
+        setParameter(processor, "LowCut Freq", flip ? 80.f : 90.f);
+        setParameter(processor, "HighCut Freq", flip ? 12000.f : 11000.f);
+        setParameter(processor, "Peak Freq", flip ? 1000.f : 1100.f);
+        setParameter(processor, "Peak Gain", flip ? 6.f : 5.f);
+        setParameter(processor, "Peak Quality", flip ? 1.f : 2.f);
+    };
+
+    auto allChanged = measureMedianCycles(numRuns, changeEveryBand, [&processor] {
+        ProcessorBenchmarkAccess::updateFilters(processor);
+    });
+
+    results.add(makeResult("updateFilters/offline_all_changed", allChanged, numRuns).get());
+}
+
+// A full snapshot of the settings through the parameter table, against only checking whether
+// anything changed since the last one
+static void benchmarkGetChainSettings(juce::Array<juce::var>& results) {
+    constexpr int callsPerRun = 100;
+    constexpr int numRuns = 2000;
+
+    SimpleEQAudioProcessor processor;
+    const auto& parameters = processor.getParameterTable();
+    ChainSettings chainSettings;
+    auto peakFreqSum = 0.f;
+    auto numChanged = 0;
+
+    auto addResult = [&](const juce::String& name, double cycles) {
+        auto result = makeResult(name, cycles / callsPerRun, numRuns);
+        result->setProperty("calls_per_run", callsPerRun);
+        results.add(result.get());
+    };
+
+    addResult("getChainSettings", measureMedianCycles(numRuns, [] {}, [&] {
+        for (int i = 0; i < callsPerRun; ++i) {
+            chainSettings = parameters.getChainSettings();
+            peakFreqSum += chainSettings.peaks[0].freq;
+        }
+    }));
+
+    // Halfway towards "Vocal Presence"
+    setParameter(processor, "Morph Target", 2.f);
+    setParameter(processor, "Morph", 0.5f);
+
+    addResult("getChainSettings/morph", measureMedianCycles(numRuns, [] {}, [&] {
+        for (int i = 0; i < callsPerRun; ++i) {
+            chainSettings = parameters.getChainSettings();
+            peakFreqSum += chainSettings.peaks[0].freq;
+        }
+    }));
+
+    auto generation = parameters.getGeneration();
+
+    addResult("getChainSettings/unchanged_check", measureMedianCycles(numRuns, [] {}, [&] {
+        for (int i = 0; i < callsPerRun; ++i) {
+            numChanged += parameters.hasChangedSince(generation) ? 1 : 0;
+        }
+    }));
+
+    // Keeps the calls from being optimised away
+    if (peakFreqSum < 0.f || numChanged < 0) {
+        std::cerr << peakFreqSum << numChanged;
+    }
+}
+
+// The first updateFilters() after a program switch - live, where the program's coefficients are
+// ready made, and offline, where the new settings are designed inline as for any other change
+static void benchmarkPrograms(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numRuns = 2000;
+
+    SimpleEQAudioProcessor processor;
+    prepareProcessor(processor, sampleRate, blockSize);
+
+    // "Vocal Presence" and "Warmth", which differ in both cuts and the first two peak bands
+    auto program = 2;
+    auto switchProgram = [&] {
+        program = program == 2 ? 4 : 2;
+        processor.setCurrentProgram(program);
+    };
+
+    auto callUpdate = [&processor] { ProcessorBenchmarkAccess::updateFilters(processor); };
+
+    results.add(makeResult("programs/switch_realtime", measureMedianCycles(numRuns, switchProgram, callUpdate), numRuns).get());
+
+    processor.releaseResources();
+    processor.setNonRealtime(true);
+
+    results.add(makeResult("programs/switch_offline", measureMedianCycles(numRuns, switchProgram, callUpdate), numRuns).get());
+}
+
+// Saving the state, and loading it back in the binary format and as a ValueTree, as sessions
+// saved before the binary format still are. Loads alternate between two states so each one
+// moves every peak band, which is what a session full of instances does on opening.
+static void benchmarkState(juce::Array<juce::var>& results) {
+    constexpr int numRuns = 500;
+
+    SimpleEQAudioProcessor processor;
+    const auto& peakParameterIDs = getPeakParameterIDs();
+
+    auto setPeakGains = [&](float gainInDecibels) {
+        for (const auto& ids : peakParameterIDs) {
+            setParameter(processor, ids.gain, gainInDecibels);
+        }
+    };
+
+    std::array<juce::MemoryBlock, 2> binaryStates, treeStates;
+
+    for (size_t i = 0; i < binaryStates.size(); ++i) {
+        setPeakGains(i == 0 ? 3.f : -3.f);
+        processor.getStateInformation(binaryStates[i]);
+
+        juce::MemoryOutputStream mos(treeStates[i], false);
+        processor.apvts.copyState().writeToStream(mos);
+    }
+
+    auto addResult = [&](const juce::String& name, double cycles, size_t stateSize) {
+        auto result = makeResult("state/" + name, cycles, numRuns);
+        result->setProperty("bytes", static_cast<int>(stateSize));
+        results.add(result.get());
+    };
+
+    juce::MemoryBlock saved;
+
+    addResult("save", measureMedianCycles(numRuns, [&] { saved.reset(); }, [&] {
+        processor.getStateInformation(saved);
+    }), binaryStates[0].getSize());
+
+    for (auto binary : {true, false}) {
+        const auto& states = binary ? binaryStates : treeStates;
+        size_t next = 0;
+
+        addResult(binary ? "load_binary" : "load_value_tree", measureMedianCycles(numRuns, [&] { next ^= 1; }, [&] {
+            processor.setStateInformation(states[next].getData(), static_cast<int>(states[next].getSize()));
+        }), states[0].getSize());
+    }
+}
+
+// What ResponseCurveComponent computes, for a few widths around the editor's: every stage from
+// scratch, after one stage changed, and with nothing changed
+static void benchmarkResponseCurve(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int numRuns = 500;
+
+    auto chainSettings = makeActiveChainSettings();
+    ChainCoefficients coefficients, peakChanged;
+    updateChainCoefficients(coefficients, chainSettings, sampleRate);
+
+    chainSettings.peaks[0].gainInDecibels = 3.f;
+    updateChainCoefficients(peakChanged, chainSettings, sampleRate);
+
+    for (int width : {300, 600, 1200}) {
+        ResponseCurve responseCurve;
+        auto flip = false;
+
+        auto addResult = [&](const juce::String& name, double cycles) {
+            auto result = makeResult("responseCurve/" + juce::String(width) + "/" + name, cycles, numRuns);
+            result->setProperty("points", width);
+            result->setProperty("cycles_per_point", cycles / width);
+            results.add(result.get());
+        };
+
+        addResult("all_stages", measureMedianCycles(numRuns, [&] { responseCurve = ResponseCurve(); }, [&] {
+            responseCurve.update(coefficients, width, sampleRate);
+        }));
+
+        addResult("one_stage", measureMedianCycles(numRuns, [&] { flip = !flip; }, [&] {
+            responseCurve.update(flip ? peakChanged : coefficients, width, sampleRate);
+        }));
+
+        addResult("unchanged", measureMedianCycles(numRuns, [] {}, [&] {
+            responseCurve.update(coefficients, width, sampleRate);
+        }));
+    }
+}
+
+static void benchmarkFrequencyResponse(juce::Array<juce::var>& results) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int numRuns = 200;
+
+    ChainCoefficients coefficients;
+    updateChainCoefficients(coefficients, makeActiveChainSettings(), sampleRate);
+
+    std::vector<CoefficientArray> biquads(coefficients.lowCut.begin(), coefficients.lowCut.end());
+    biquads.push_back(coefficients.peaks[0]);
+    biquads.insert(biquads.end(), coefficients.highCut.begin(), coefficients.highCut.end());
+
+    for (int numPoints : {1024, 8192}) {
+        std::vector<double> frequencies(static_cast<size_t>(numPoints));
+
+        for (size_t i = 0; i < frequencies.size(); ++i) {
+            frequencies[i] = juce::mapToLog10(static_cast<double>(i) / static_cast<double>(numPoints), 20.0, 20000.0);
+        }
+
+        FrequencyResponse frequencyResponse;
+        frequencyResponse.prepare(frequencies.data(), frequencies.size(), sampleRate);
+        std::vector<double> magnitudes(frequencies.size()), phases(frequencies.size());
+
+        auto addResult = [&](const juce::String& name, double cycles) {
+            auto result = makeResult("frequencyResponse/" + juce::String(numPoints) + "/" + name, cycles, numRuns);
+            result->setProperty("points", numPoints);
+            result->setProperty("biquads", static_cast<int>(biquads.size()));
+            result->setProperty("cycles_per_point", cycles / numPoints);
+            results.add(result.get());
+        };
+
+        addResult("magnitude", measureMedianCycles(numRuns, [] {}, [&] {
+            frequencyResponse.process(biquads.data(), biquads.size(), magnitudes.data());
+        }));
+
+        addResult("magnitude_and_phase", measureMedianCycles(numRuns, [] {}, [&] {
+            frequencyResponse.process(biquads.data(), biquads.size(), magnitudes.data(), phases.data());
+        }));
+    }
+}
+
+// Every parameter sweeps its whole range at its own rate, changing before every block like dense
+// host automation, with blocks of random size and with smoothing off and on. All of it on a thread
+// standing in for the host's audio thread, so the parameter changes take the path automation does:
+// ParameterTable's listener holds everything the plugin does with them to the same rules as
+// processBlock. JUCE's own parameter listener lock, which comes before it, is the host's business.
+static int runRealtimeCheck() {
+#if SIMPLEEQ_REALTIME_CHECKS
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int maxBlockSize = 1024;
+    constexpr int numBlocks = 4000;
+
+    SimpleEQAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+    processor.prepareToPlay(sampleRate, maxBlockSize);
+    // As with an editor open, so feeding the analyzer's fifos is checked too
+    processor.setAnalyzerEnabled(true);
+
+    auto source = makeNoise(numChannels, maxBlockSize);
+    juce::AudioBuffer<float> buffer(numChannels, maxBlockSize);
+    juce::MidiBuffer midiMessages;
+    juce::Random random(4321);
+
+    const auto& parameters = processor.getParameters();
+    auto* smoothingTime = processor.apvts.getParameter("Smoothing Time");
+
+    clearRealtimeViolations();
+
+    std::thread audioThread([&] {
+        for (auto smoothingTimeInMs : {0.f, 50.f}) {
+            setParameter(processor, "Smoothing Time", smoothingTimeInMs);
+
+            for (int block = 0; block < numBlocks; ++block) {
+                for (int i = 0; i < parameters.size(); ++i) {
+                    if (parameters[i] == smoothingTime) {
+                        continue;
+                    }
+
+                    auto period = 50 + 37 * i;
+                    auto phase = static_cast<float>(block % period) / static_cast<float>(period);
+                    parameters[i]->setValueNotifyingHost(1.f - std::abs(2.f * phase - 1.f));
+                }
+
+                auto numSamples = 1 + random.nextInt(maxBlockSize);
+                buffer.setSize(numChannels, numSamples, false, false, true);
+
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    buffer.copyFrom(channel, 0, source, channel, 0, numSamples);
+                }
+
+                processor.processBlock(buffer, midiMessages);
+            }
+        }
+    });
+
+    audioThread.join();
+    processor.releaseResources();
+
+    if (getNumRealtimeViolations() > 0) {
+        std::cerr << getRealtimeViolationReport();
+        return 1;
+    }
+
+    std::cout << 2 * numBlocks << " processBlock calls without a real-time violation\n";
+    return 0;
+#else
+    std::cerr << "--realtime-check needs a build with SIMPLEEQ_REALTIME_CHECKS\n";
+    return 1;
+#endif
+}
+
+// Writes what failed to std::cerr, returns whether the check held
+static bool expect(bool condition, const juce::String& failure) {
+    if (!condition) {
+        std::cerr << "  " << failure << "\n";
+    }
+
+    return condition;
+}
+
+// State variable filters have the same magnitude response as the biquads they replace - each
+// topology's impulse response, measured at points across the band, against the response the
+// designed sections describe. With a 20 Hz 48 dB/oct low cut, and at 192 kHz, where biquads have
+// the hardest time.
+static bool checkTopology() {
+    constexpr int numPoints = 32;
+    constexpr int blockSize = 512;
+    // Below this the response is too far down for its error in dB to mean anything
+    constexpr double floorInDecibels = -60.0;
+    constexpr double toleranceInDecibels = 0.01;
+
+    auto passed = true;
+
+    for (double sampleRate : {48000.0, 192000.0}) {
+        auto chainSettings = makeActiveChainSettings();
+        chainSettings.lowCutFreq = 20.f;
+
+        ChainCoefficients coefficients;
+        updateChainCoefficients(coefficients, chainSettings, sampleRate);
+
+        std::vector<double> frequencies(numPoints), expected(numPoints);
+
+        // Each section's transfer function evaluated directly - FrequencyResponse's expansion into
+        // cosines loses too much to cancellation this close to DC
+        for (size_t i = 0; i < frequencies.size(); ++i) {
+            frequencies[i] = juce::mapToLog10(static_cast<double>(i) / (numPoints - 1), 20.0, 20000.0);
+
+            auto z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate);
+            std::complex<double> response {1.0};
+
+            forEachActiveSection(coefficients, [&response, z1](size_t, const CoefficientArray& section) {
+                response *= (section[0] + z1 * (section[1] + z1 * section[2])) / (section[3] + z1 * (section[4] + z1 * section[5]));
+            });
+
+            expected[i] = juce::Decibels::gainToDecibels(std::abs(response), -300.0);
+        }
+
+        // Long enough for the impulse response to have died away
+        auto length = static_cast<int>(std::ceil(getChainTailSeconds(coefficients) * sampleRate));
+
+        for (auto topology : {FilterTopology_Biquad, FilterTopology_StateVariable}) {
+            SIMDBiquadCascade cascade;
+            cascade.prepare({sampleRate, static_cast<juce::uint32>(blockSize), 1});
+            cascade.setTopology(topology);
+            cascade.setCoefficients(coefficients);
+
+            juce::AudioBuffer<double> impulseResponse(1, length);
+            impulseResponse.clear();
+            impulseResponse.setSample(0, 0, 1.0);
+
+            juce::dsp::AudioBlock<double> block(impulseResponse);
+
+            for (int start = 0; start < length; start += blockSize) {
+                cascade.process(block.getSubBlock(static_cast<size_t>(start),
+                                                  static_cast<size_t>(juce::jmin(blockSize, length - start))));
+            }
+
+            auto maxError = 0.0;
+
+            for (size_t i = 0; i < frequencies.size(); ++i) {
+                if (expected[i] < floorInDecibels) {
+                    continue;
+                }
+
+                // The impulse response's DFT at the point, turning the phasor one sample at a time
+                auto rotation = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate);
+                std::complex<double> phasor {1.0}, response;
+
+                for (int n = 0; n < length; ++n) {
+                    response += impulseResponse.getSample(0, n) * phasor;
+                    phasor *= rotation;
+                }
+
+                maxError = juce::jmax(maxError, std::abs(juce::Decibels::gainToDecibels(std::abs(response), -300.0) - expected[i]));
+            }
+
+            auto name = juce::String(static_cast<int>(sampleRate)) + " Hz "
+                      + (topology == FilterTopology_StateVariable ? "state variable filters" : "biquads");
+
+            passed &= expect(maxError < toleranceInDecibels, name + ": magnitude response off by up to "
+                                                             + juce::String(maxError) + " dB");
+        }
+    }
+
+    // In single precision the biquads' poles, this close to z = 1, are rounded far enough to move the
+    // response - a second of noise through a 40 Hz bell with a Q of 10 and the 20 Hz low cut, each
+    // topology's float output against the double precision biquads'
+    constexpr double sampleRate = 192000.0;
+    constexpr double floatToleranceInDecibels = -60.0;
+
+    auto chainSettings = makeActiveChainSettings();
+    chainSettings.lowCutFreq = 20.f;
+    chainSettings.peaks[0].freq = 40.f;
+    chainSettings.peaks[0].gainInDecibels = 12.f;
+    chainSettings.peaks[0].quality = 10.f;
+
+    ChainCoefficients coefficients;
+    updateChainCoefficients(coefficients, chainSettings, sampleRate);
+
+    auto noise = makeNoise(1, static_cast<int>(sampleRate));
+
+    auto run = [&](FilterTopology topology, auto sampleType) {
+        SIMDBiquadCascade cascade;
+        cascade.prepare({sampleRate, static_cast<juce::uint32>(noise.getNumSamples()), 1});
+        cascade.setTopology(topology);
+        cascade.setCoefficients(coefficients);
+        return runCascade<decltype(sampleType)>(cascade, noise, 1);
+    };
+
+    auto reference = run(FilterTopology_Biquad, 0.0);
+    auto biquadError = getErrorDecibels(run(FilterTopology_Biquad, 0.f), reference);
+    auto stateVariableError = getErrorDecibels(run(FilterTopology_StateVariable, 0.f), reference);
+
+    passed &= expect(stateVariableError < floatToleranceInDecibels, "192000 Hz float state variable filters: off by "
+                                                                    + juce::String(stateVariableError) + " dB");
+    // Or the case is too easy to show anything
+    passed &= expect(biquadError > floatToleranceInDecibels, "192000 Hz float biquads: only off by "
+                                                             + juce::String(biquadError) + " dB");
+
+    return passed;
+}
+
+// Once the input stops, nothing at all comes out after getTailLengthSeconds() - hosts may stop
+// calling processBlock there, or mix whatever does come out into the next region
+static bool checkTail() {
+    constexpr int numChannels = 2;
+
+    auto check = [](SimpleEQAudioProcessor& processor, const juce::String& name) {
+        auto noise = makeNoise(numChannels, static_cast<int>(checkSampleRate));
+        processInBlocks(processor, noise, checkBlockSize);
+
+        auto tailSamples = static_cast<int>(std::ceil(processor.getTailLengthSeconds() * checkSampleRate));
+        juce::AudioBuffer<float> silence(numChannels, tailSamples + static_cast<int>(checkSampleRate));
+        silence.clear();
+        processInBlocks(processor, silence, checkBlockSize);
+
+        auto lastSound = -1;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            for (int i = tailSamples; i < silence.getNumSamples(); ++i) {
+                if (silence.getSample(channel, i) != 0.f) {
+                    lastSound = juce::jmax(lastSound, i);
+                }
+            }
+        }
+
+        return expect(lastSound < 0, name + ": output until " + juce::String(lastSound)
+                                     + " samples after the input stopped, the tail is " + juce::String(tailSamples));
+    };
+
+    return checkVariants({{"minimum phase", "Phase Mode", 0.f},
+                          {"4x oversampling", "Oversampling", 2.f},
+                          {"linear phase", "Phase Mode", 1.f}}, {}, check);
+}
+
+// With "Bypass" on, what comes out is exactly what went in, delayed by the latency the host was
+// told about - once the bands have ramped out and the input goes around the engines
+static bool checkBypass() {
+    constexpr int numChannels = 2;
+    // Longer than the bands take to ramp out and the engines to crossfade to the delay
+    constexpr int settleSamples = 4800;
+
+    auto check = [](SimpleEQAudioProcessor& processor, const juce::String& name) {
+        auto input = makeNoise(numChannels, static_cast<int>(checkSampleRate));
+        auto output = input;
+        processInBlocks(processor, output, checkBlockSize);
+
+        auto latency = processor.getLatencySamples();
+        auto maxError = 0.f;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            for (int i = juce::jmax(settleSamples, latency); i < output.getNumSamples(); ++i) {
+                maxError = juce::jmax(maxError, std::abs(output.getSample(channel, i) - input.getSample(channel, i - latency)));
+            }
+        }
+
+        return expect(maxError == 0.f, name + ": differs from the input delayed by "
+                                       + juce::String(latency) + " samples by up to " + juce::String(maxError));
+    };
+
+    return checkVariants({{"minimum phase", "Phase Mode", 0.f},
+                          {"2x oversampling", "Oversampling", 1.f},
+                          {"4x oversampling", "Oversampling", 2.f},
+                          {"linear phase", "Phase Mode", 1.f}}, {{"Bypass", 1.f}}, check);
+}
+
+// Whether every parameter of processor has the same value as other's
+static bool haveSameValues(SimpleEQAudioProcessor& processor, SimpleEQAudioProcessor& other) {
+    const auto& parameters = processor.getParameters();
+    const auto& otherParameters = other.getParameters();
+
+    for (int i = 0; i < parameters.size(); ++i) {
+        if (!juce::approximatelyEqual(parameters[i]->getValue(), otherParameters[i]->getValue())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// A state saved by getStateInformation() loads back exactly, in the binary format and from the
+// ValueTree sessions saved before it still hold - and one whose CRC doesn't match is ignored
+static bool checkState() {
+    SimpleEQAudioProcessor saved;
+    setActiveSettings(saved);
+    prepareProcessor(saved, 48000.0, 512, {{"Peak 2 Gain", -3.f}, {"Peak 2 Type", static_cast<float>(PeakType_HighShelf)},
+                                           {"Oversampling", 1.f}, {"Filter Topology", 1.f}});
+    saved.changeProgramName(5, "Saved");
+
+    juce::MemoryBlock binaryState, treeState;
+    saved.getStateInformation(binaryState);
+
+    {
+        juce::MemoryOutputStream stream(treeState, false);
+        saved.apvts.copyState().writeToStream(stream);
+    }
+
+    auto passed = true;
+
+    SimpleEQAudioProcessor binaryLoaded;
+    binaryLoaded.setStateInformation(binaryState.getData(), static_cast<int>(binaryState.getSize()));
+    passed &= expect(haveSameValues(binaryLoaded, saved), "the binary state loads different parameter values");
+    passed &= expect(binaryLoaded.getProgramName(5) == "Saved", "the binary state loads different program names");
+
+    SimpleEQAudioProcessor treeLoaded;
+    treeLoaded.setStateInformation(treeState.getData(), static_cast<int>(treeState.getSize()));
+    passed &= expect(haveSameValues(treeLoaded, saved), "the ValueTree state loads different parameter values");
+
+    // A bit flipped in the first value, after the four ints of the header - still a valid float,
+    // which nothing but the CRC can catch
+    juce::MemoryBlock corruptState(binaryState);
+    static_cast<char*>(corruptState.getData())[4 * sizeof(juce::int32)] ^= 1;
+
+    SimpleEQAudioProcessor corruptLoaded, untouched;
+    corruptLoaded.setStateInformation(corruptState.getData(), static_cast<int>(corruptState.getSize()));
+    passed &= expect(haveSameValues(corruptLoaded, untouched), "a state with the wrong CRC changes parameter values");
+
+    return passed;
+}
+
+// The sections forEachActiveSection() runs, by slot - what's in the others doesn't matter
+static std::vector<std::pair<size_t, CoefficientArray>> getActiveSections(const ChainCoefficients& coefficients) {
+    std::vector<std::pair<size_t, CoefficientArray>> sections;
+
+    forEachActiveSection(coefficients, [&sections](size_t slot, const CoefficientArray& section) {
+        sections.emplace_back(slot, section);
+    });
+
+    return sections;
+}
+
+// After setCurrentProgram() every parameter a program recalls has the program's value, and the
+// next block switches to the program's ready made coefficients - which are what designing the
+// parameters' settings from scratch gives. For every factory program, and for one stored over
+// since the processor was prepared.
+static bool checkPrograms() {
+    constexpr double sampleRate = 48000.0;
+
+    SimpleEQAudioProcessor processor;
+    prepareProcessor(processor, sampleRate, 512);
+
+    auto& presetBank = ProcessorBenchmarkAccess::getPresetBank(processor);
+    const auto& parameterTable = processor.getParameterTable();
+    const auto& parameters = processor.getParameters();
+    auto passed = true;
+
+    auto checkProgram = [&](int program) {
+        processor.setCurrentProgram(program);
+
+        const auto& values = presetBank.getValues(program);
+        auto name = "\"" + processor.getProgramName(program) + "\"";
+
+        for (int i = 0; i < parameters.size(); ++i) {
+            auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(parameters[i]);
+            auto value = parameter->convertFrom0to1(parameter->getValue());
+
+            passed &= expect(!presetBank.isRecalled(i) || juce::approximatelyEqual(value, values[static_cast<size_t>(i)]),
+                             name + ": " + parameter->getParameterID() + " is " + juce::String(value)
+                             + " instead of " + juce::String(values[static_cast<size_t>(i)]));
+        }
+
+        ProcessorBenchmarkAccess::updateFilters(processor);
+
+        if (!expect(ProcessorBenchmarkAccess::isUsingProgramCoefficients(processor),
+                    name + ": its ready made coefficients weren't used")) {
+            passed = false;
+            return;
+        }
+
+        auto rate = parameterTable.getProcessingSampleRate(sampleRate);
+        ChainCoefficients designed;
+        updateChainCoefficients(designed, parameterTable.getChainSettings(), rate);
+
+        passed &= expect(getActiveSections(*presetBank.getCoefficients(program, rate)) == getActiveSections(designed),
+                         name + ": its coefficients differ from the parameters' design");
+    };
+
+    for (int program = 1; program < numPrograms; ++program) {
+        checkProgram(program);
+    }
+
+    setParameter(processor, "Peak Gain", -9.f);
+    processor.storeProgram(3);
+    checkProgram(0);
+    checkProgram(3);
+
+    return passed;
+}
+
+// Checks of what the plugin promises hosts, rather than of what it costs - prints each one's
+// outcome and returns 1 if any failed
+static int runChecks() {
+    const std::vector<std::pair<const char*, bool (*)()>> checks {{"topology", checkTopology},
+                                                                    {"tail", checkTail},
+                                                                    {"bypass", checkBypass},
+                                                                    {"state", checkState},
+                                                                    {"programs", checkPrograms}};
+
+    auto numFailed = 0;
+
+    for (const auto& [name, check] : checks) {
+        auto passed = check();
+        std::cout << name << ": " << (passed ? "passed" : "FAILED") << "\n";
+        numFailed += passed ? 0 : 1;
+    }
+
+    return numFailed > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    juce::File outputFile;
+    auto realtimeCheck = false, checks = false;
+    auto args = juce::StringArray(argv + 1, argc - 1);
+
+    if (args.size() == 2 && args[0] == "--output") {
+        outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[1]);
+    } else if (args.size() == 1 && args[0] == "--realtime-check") {
+        realtimeCheck = true;
+    } else if (args.size() == 1 && args[0] == "--check") {
+        checks = true;
+    } else if (!args.isEmpty()) {
+        std::cerr << "usage: SimpleEQBenchmark [--output <file> | --realtime-check | --check]\n";
+        return 1;
+    }
+
+    // The message loop never runs, the MessageManager only has to exist because the parameter
+    // state's timer registers with it
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (realtimeCheck) {
+        return runRealtimeCheck();
+    }
+
+    if (checks) {
+        return runChecks();
+    }
+
+    juce::Array<juce::var> results;
+    benchmarkStereoCascade(results);
+    benchmarkChannelCounts(results);
+    benchmarkPrecision(results);
+    benchmarkLinearPhase(results);
+    benchmarkProcessBlock(results);
+    benchmarkOversampling(results);
+    benchmarkSilence(results);
+    benchmarkBypass(results);
+    benchmarkPeakBands(results);
+    benchmarkAutomation(results);
+    benchmarkUpdateFilters(results);
+    benchmarkGetChainSettings(results);
+    benchmarkPrograms(results);
+    benchmarkState(results);
+    benchmarkResponseCurve(results);
+    benchmarkFrequencyResponse(results);
+
+    juce::DynamicObject::Ptr context = new juce::DynamicObject();
+    context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    context->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    context->setProperty("cpu", juce::SystemStats::getCpuModel());
+    context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    context->setProperty("counter", getCounterName());
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("context", context.get());
+    report->setProperty("benchmarks", results);
+
+    auto json = juce::JSON::toString(report.get());
+
+    if (outputFile == juce::File()) {
+        std::cout << json << "\n";
+    } else if (!outputFile.replaceWithText(json)) {
+        std::cerr << outputFile.getFullPathName() << ": can't be written\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "ChainSmoother.h"
+
+template<typename SmoothedValueType>
+static void resetKeepingRamp(SmoothedValueType& value, double sampleRate, double rampLengthInSeconds) {
+    // SmoothedValue::reset() jumps straight to the target, so restart the ramp from where it was
+    auto current = value.getCurrentValue();
+    auto targetValue = value.getTargetValue();
+
+    value.reset(sampleRate, rampLengthInSeconds);
+    value.setCurrentAndTargetValue(current);
+    value.setTargetValue(targetValue);
+}
+
+void ChainSmoother::reset(double sampleRate, double rampLengthInSeconds) {
+    resetKeepingRamp(lowCutFreq, sampleRate, rampLengthInSeconds);
+    resetKeepingRamp(highCutFreq, sampleRate, rampLengthInSeconds);
+    resetKeepingRamp(lowCutMix, sampleRate, bypassRampSeconds);
+    resetKeepingRamp(highCutMix, sampleRate, bypassRampSeconds);
+
+    for (auto& peak : peaks) {
+        resetKeepingRamp(peak.freq, sampleRate, rampLengthInSeconds);
+        resetKeepingRamp(peak.quality, sampleRate, rampLengthInSeconds);
+        resetKeepingRamp(peak.gainInDecibels, sampleRate, rampLengthInSeconds);
+        resetKeepingRamp(peak.mix, sampleRate, bypassRampSeconds);
+    }
+}
+
+void ChainSmoother::setCurrentAndTargetValue(const ChainSettings& chainSettings) {
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+    lowCutMix.setCurrentAndTargetValue(chainSettings.lowCutMix);
+    highCutMix.setCurrentAndTargetValue(chainSettings.highCutMix);
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        const auto& settings = chainSettings.peaks[band];
+        auto& peak = peaks[band];
+
+        peak.freq.setCurrentAndTargetValue(settings.freq);
+        peak.quality.setCurrentAndTargetValue(settings.quality);
+        peak.gainInDecibels.setCurrentAndTargetValue(settings.gainInDecibels);
+        peak.mix.setCurrentAndTargetValue(settings.mix);
+    }
+
+    target = chainSettings;
+}
+
+void ChainSmoother::setTargetValue(const ChainSettings& chainSettings) {
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+    lowCutMix.setTargetValue(chainSettings.lowCutMix);
+    highCutMix.setTargetValue(chainSettings.highCutMix);
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        const auto& settings = chainSettings.peaks[band];
+        auto& peak = peaks[band];
+
+        peak.freq.setTargetValue(settings.freq);
+        peak.quality.setTargetValue(settings.quality);
+        peak.gainInDecibels.setTargetValue(settings.gainInDecibels);
+        peak.mix.setTargetValue(settings.mix);
+    }
+
+    target = chainSettings;
+}
+
+bool ChainSmoother::isSmoothing() const {
+    auto peakIsSmoothing = [](const PeakSmoother& peak) {
+        return peak.freq.isSmoothing() || peak.quality.isSmoothing()
+            || peak.gainInDecibels.isSmoothing() || peak.mix.isSmoothing();
+    };
+
+    return lowCutFreq.isSmoothing()
+        || highCutFreq.isSmoothing()
+        || lowCutMix.isSmoothing()
+        || highCutMix.isSmoothing()
+        || std::any_of(peaks.begin(), peaks.end(), peakIsSmoothing);
+}
+
+ChainSettings ChainSmoother::skip(int numSamples) {
+    auto chainSettings = target;
+
+    chainSettings.lowCutFreq = lowCutFreq.skip(numSamples);
+    chainSettings.highCutFreq = highCutFreq.skip(numSamples);
+    chainSettings.lowCutMix = lowCutMix.skip(numSamples);
+    chainSettings.highCutMix = highCutMix.skip(numSamples);
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        auto& settings = chainSettings.peaks[band];
+        auto& peak = peaks[band];
+
+        settings.freq = peak.freq.skip(numSamples);
+        settings.quality = peak.quality.skip(numSamples);
+        settings.gainInDecibels = peak.gainInDecibels.skip(numSamples);
+        settings.mix = peak.mix.skip(numSamples);
+    }
+
+    return chainSettings;
+}
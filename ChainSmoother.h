@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+
+// Ramps ChainSettings towards their target over a configurable time, so the chain can be
+// redesigned every few samples instead of jumping once per host block.
+// Frequencies and Q are ramped multiplicatively (evenly on the log scale they are heard on),
+// gain linearly in dB. Slopes, peak types and the filter design can't be interpolated and switch
+// as soon as they are targeted. Bands being bypassed or brought back are crossfaded over bypassRampSeconds
+// whatever the ramp length, so bypassing never clicks, even with smoothing off.
+class ChainSmoother {
+public:
+    // Changes the ramp length, carrying on from wherever the current ramp is
+    void reset(double sampleRate, double rampLengthInSeconds);
+
+    void setCurrentAndTargetValue(const ChainSettings& chainSettings);
+    void setTargetValue(const ChainSettings& chainSettings);
+
+    bool isSmoothing() const;
+    // The settings last targeted, which the ramp ends at
+    const ChainSettings& getTargetValue() const { return target; }
+
+    // Advances the ramp by numSamples and returns the settings reached
+    ChainSettings skip(int numSamples);
+
+private:
+    static constexpr double bypassRampSeconds = 0.01;
+
+    struct PeakSmoother {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, quality;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainInDecibels, mix;
+    };
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq, highCutFreq;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> lowCutMix, highCutMix;
+    std::array<PeakSmoother, numPeakBands> peaks;
+    ChainSettings target;
+};
@@ -0,0 +1,62 @@
+#include "CoefficientDesigner.h"
+
+CoefficientDesigner::CoefficientDesigner(ParameterTable& table)
+    : juce::Thread("SimpleEQ Coefficient Designer"), parameters(table) {
+    parameters.setListener(this);
+}
+
+CoefficientDesigner::~CoefficientDesigner() {
+    release();
+    parameters.setListener(nullptr);
+}
+
+void CoefficientDesigner::prepare(double newSampleRate) {
+    release();
+
+    sampleRate = newSampleRate;
+    designAndPublish();
+
+    startThread();
+}
+
+void CoefficientDesigner::release() {
+    // The thread sleeps on wake rather than on its own event, which stopThread() would signal
+    signalThreadShouldExit();
+    wake.signal();
+    stopThread(1000);
+}
+
+void CoefficientDesigner::run() {
+    while (!threadShouldExit()) {
+        if (bulkChanges == 0 && parameters.hasChangedSince(designedGeneration)) {
+            designAndPublish();
+        }
+
+        // Sleeps until something changes - a change made while designing wakes it straight away
+        wake.wait();
+    }
+}
+
+void CoefficientDesigner::parametersChanged() noexcept {
+    // Host automation calls this on the audio thread, where signalling mustn't lock
+    if (bulkChanges == 0) {
+        wake.signal();
+    }
+}
+
+void CoefficientDesigner::endBulkChange() {
+    if (--bulkChanges == 0) {
+        wake.signal();
+    }
+}
+
+void CoefficientDesigner::designAndPublish() {
+    // Read first, so a change that lands while designing is designed again once it's signalled
+    designedGeneration = parameters.getGeneration();
+
+    // The audio thread switches oversampling factor when coefficients for another rate come through
+    updateChainCoefficients(working, parameters.getChainSettings(), parameters.getProcessingSampleRate(sampleRate));
+
+    designed.getWriteBuffer() = working;
+    designed.publish();
+}
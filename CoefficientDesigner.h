@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ParameterTable.h"
+#include "TripleBuffer.h"
+#include "WakeSignal.h"
+
+// Designs the whole chain's coefficients on a background thread whenever a parameter moves
+// and hands them to the audio thread through a TripleBuffer, so processBlock only ever copies
+// finished coefficients no matter how fast the parameters are automated.
+class CoefficientDesigner final : private juce::Thread,
+                                  private ParameterTable::Listener {
+public:
+    explicit CoefficientDesigner(ParameterTable& parameters);
+    ~CoefficientDesigner() override;
+
+    // Not thread safe against pull() - call from prepareToPlay only.
+    // Designs and publishes the current settings before (re)starting the thread.
+    void prepare(double sampleRate);
+    void release();
+
+    // Audio thread - the newest designed coefficients, or nullptr if nothing changed since the last pull
+    const ChainCoefficients* pull() { return designed.pull(); }
+
+    // Holds off designing while many parameters change at once, e.g. while a state is loaded, so
+    // the chain is designed once when the last one goes out of scope instead of along the way
+    class ScopedBulkChange {
+    public:
+        explicit ScopedBulkChange(CoefficientDesigner& d) : designer(d) { ++designer.bulkChanges; }
+        ~ScopedBulkChange() { designer.endBulkChange(); }
+
+    private:
+        CoefficientDesigner& designer;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBulkChange)
+    };
+
+private:
+    void run() override;
+    void parametersChanged() noexcept override;
+    void designAndPublish();
+    void endBulkChange();
+
+    ParameterTable& parameters;
+    TripleBuffer<ChainCoefficients> designed;
+    ChainCoefficients working;
+    double sampleRate {0.0};
+    // parameters' generation when working was last designed - anything newer needs a redesign
+    juce::uint32 designedGeneration {0};
+    std::atomic<int> bulkChanges {0};
+    // Signalled on every change, from whichever thread made it
+    WakeSignal wake;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientDesigner)
+};
@@ -0,0 +1,154 @@
+#include "FrequencyResponse.h"
+
+void FrequencyResponse::prepare(const double* frequencies, size_t newNumFrequencies, double sampleRate) {
+    numFrequencies = newNumFrequencies;
+
+    auto numGroups = (numFrequencies + numLanes - 1) / numLanes;
+
+    for (auto* table : {&cos1, &cos2, &sin1, &sin2}) {
+        table->resize(numGroups);
+    }
+
+    for (size_t group = 0; group < numGroups; ++group) {
+        alignas(Register) double c1[numLanes], c2[numLanes], s1[numLanes], s2[numLanes];
+
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            auto index = group * numLanes + lane;
+            auto w = index < numFrequencies
+                   ? juce::MathConstants<double>::twoPi * frequencies[index] / sampleRate
+                   : 0.0;
+
+            c1[lane] = std::cos(w);
+            c2[lane] = std::cos(2.0 * w);
+            s1[lane] = std::sin(w);
+            s2[lane] = std::sin(2.0 * w);
+        }
+
+        cos1[group] = Register::fromRawArray(c1);
+        cos2[group] = Register::fromRawArray(c2);
+        sin1[group] = Register::fromRawArray(s1);
+        sin2[group] = Register::fromRawArray(s2);
+    }
+}
+
+void FrequencyResponse::process(const CoefficientArray* biquads, size_t numBiquads,
+                                double* magnitudesInDecibels, double* phasesInRadians) const {
+    if (phasesInRadians != nullptr) {
+        processGroups<true>(biquads, numBiquads, magnitudesInDecibels, phasesInRadians);
+    }
+    else {
+        processGroups<false>(biquads, numBiquads, magnitudesInDecibels, phasesInRadians);
+    }
+}
+
+// IIR::Coefficients stores b0, b1, b2, a1, a2 with a0 already divided out
+static CoefficientArray toCoefficientArray(const juce::dsp::IIR::Coefficients<float>& coefficients) {
+    const auto& raw = coefficients.coefficients;
+
+    if (coefficients.getFilterOrder() == 1) {
+        return {raw[0], raw[1], 0.0, 1.0, raw[2], 0.0};
+    }
+
+    jassert(coefficients.getFilterOrder() == 2);
+    return {raw[0], raw[1], raw[2], 1.0, raw[3], raw[4]};
+}
+
+void FrequencyResponse::process(const MonoChain& chain, double* magnitudesInDecibels, double* phasesInRadians) const {
+    std::array<CoefficientArray, 9> biquads;
+    size_t numBiquads = 0;
+
+    auto add = [&biquads, &numBiquads](const Filter& filter) {
+        if (filter.coefficients != nullptr) {
+            biquads[numBiquads++] = toCoefficientArray(*filter.coefficients);
+        }
+    };
+
+    auto addCutFilter = [&add](const CutFilter& cutFilter) {
+        if (!cutFilter.isBypassed<0>()) add(cutFilter.get<0>());
+        if (!cutFilter.isBypassed<1>()) add(cutFilter.get<1>());
+        if (!cutFilter.isBypassed<2>()) add(cutFilter.get<2>());
+        if (!cutFilter.isBypassed<3>()) add(cutFilter.get<3>());
+    };
+
+    if (!chain.isBypassed<ChainPositions::LowCut>()) {
+        addCutFilter(chain.get<ChainPositions::LowCut>());
+    }
+
+    if (!chain.isBypassed<ChainPositions::Peak>()) {
+        add(chain.get<ChainPositions::Peak>());
+    }
+
+    if (!chain.isBypassed<ChainPositions::HighCut>()) {
+        addCutFilter(chain.get<ChainPositions::HighCut>());
+    }
+
+    process(biquads.data(), numBiquads, magnitudesInDecibels, phasesInRadians);
+}
+
+template<bool withPhase>
+void FrequencyResponse::processGroups(const CoefficientArray* biquads, size_t numBiquads,
+                                      double* magnitudesInDecibels, double* phasesInRadians) const {
+    for (size_t group = 0; group < cos1.size(); ++group) {
+        const auto c1 = cos1[group], c2 = cos2[group];
+
+        // |numerator|^2 and |denominator|^2 of the whole cascade, and numerator * conj(denominator),
+        // whose argument is the phase
+        auto numeratorPower = Register::expand(1.0), denominatorPower = Register::expand(1.0);
+        auto phaseReal = Register::expand(1.0), phaseImag = Register::expand(0.0);
+
+        for (size_t i = 0; i < numBiquads; ++i) {
+            const auto& c = biquads[i];
+            auto b0 = c[0], b1 = c[1], b2 = c[2];
+            auto a0 = c[3], a1 = c[4], a2 = c[5];
+
+            auto power = [&c1, &c2](double x0, double x1, double x2) {
+                auto polynomial = Register::multiplyAdd(Register::expand(x0 * x0 + x1 * x1 + x2 * x2),
+                                                        Register::expand(2.0 * (x0 * x1 + x1 * x2)), c1);
+                return Register::multiplyAdd(polynomial, Register::expand(2.0 * x0 * x2), c2);
+            };
+
+            numeratorPower *= power(b0, b1, b2);
+            denominatorPower *= power(a0, a1, a2);
+
+            if constexpr (withPhase) {
+                const auto s1 = sin1[group], s2 = sin2[group];
+
+                // x0 + x1 e^-jw + x2 e^-2jw
+                auto numeratorReal = Register::multiplyAdd(Register::multiplyAdd(Register::expand(b0), c1, Register::expand(b1)),
+                                                           c2, Register::expand(b2));
+                auto numeratorImag = Register::expand(0.0) - (s1 * b1 + s2 * b2);
+                auto denominatorReal = Register::multiplyAdd(Register::multiplyAdd(Register::expand(a0), c1, Register::expand(a1)),
+                                                             c2, Register::expand(a2));
+                auto denominatorImag = Register::expand(0.0) - (s1 * a1 + s2 * a2);
+
+                // numerator * conj(denominator)
+                auto real = numeratorReal * denominatorReal + numeratorImag * denominatorImag;
+                auto imag = numeratorImag * denominatorReal - numeratorReal * denominatorImag;
+
+                auto newPhaseReal = phaseReal * real - phaseImag * imag;
+                phaseImag = phaseReal * imag + phaseImag * real;
+                phaseReal = newPhaseReal;
+            }
+        }
+
+        alignas(Register) double numerators[numLanes], denominators[numLanes], reals[numLanes], imags[numLanes];
+        numeratorPower.copyToRawArray(numerators);
+        denominatorPower.copyToRawArray(denominators);
+
+        if constexpr (withPhase) {
+            phaseReal.copyToRawArray(reals);
+            phaseImag.copyToRawArray(imags);
+        }
+
+        auto numPoints = juce::jmin(numLanes, numFrequencies - group * numLanes);
+
+        for (size_t lane = 0; lane < numPoints; ++lane) {
+            auto index = group * numLanes + lane;
+            magnitudesInDecibels[index] = 10.0 * std::log10(juce::jmax(numerators[lane], 1.0e-300) / denominators[lane]);
+
+            if constexpr (withPhase) {
+                phasesInRadians[index] = std::atan2(imags[lane], reals[lane]);
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+
+// Magnitude and phase of a whole cascade of biquads at many frequencies in one call.
+// prepare() tabulates cos and sin of w and 2w at every frequency. For real coefficients
+// |b0 + b1 e^-jw + b2 e^-2jw|^2 = (b0^2 + b1^2 + b2^2) + 2 (b0 b1 + b1 b2) cos w + 2 b0 b2 cos 2w,
+// so each biquad then only costs two multiply-adds per polynomial and point, run over
+// SIMDRegister<double>'s lanes. The products are only turned into dB (and phase) once per point,
+// after the last biquad.
+class FrequencyResponse {
+public:
+    using Register = juce::dsp::SIMDRegister<double>;
+    static constexpr size_t numLanes = Register::SIMDNumElements;
+
+    void prepare(const double* frequencies, size_t numFrequencies, double sampleRate);
+    size_t getNumFrequencies() const { return numFrequencies; }
+
+    // Each output array holds getNumFrequencies() values. Phases are wrapped to [-pi, pi].
+    void process(const CoefficientArray* biquads, size_t numBiquads,
+                 double* magnitudesInDecibels, double* phasesInRadians = nullptr) const;
+
+    // The chain's sections that aren't bypassed
+    void process(const MonoChain& chain, double* magnitudesInDecibels, double* phasesInRadians = nullptr) const;
+
+private:
+    template<bool withPhase>
+    void processGroups(const CoefficientArray* biquads, size_t numBiquads,
+                       double* magnitudesInDecibels, double* phasesInRadians) const;
+
+    size_t numFrequencies {0};
+
+    // One register per group of numLanes frequencies, the last group padded with w = 0
+    std::vector<Register> cos1, cos2, sin1, sin2;
+};
@@ -0,0 +1,242 @@
+#include "LinearPhaseEQ.h"
+
+LinearPhaseEQ::LinearPhaseEQ()
+    : juce::Thread("SimpleEQ Linear Phase Designer") {}
+
+LinearPhaseEQ::~LinearPhaseEQ() {
+    release();
+}
+
+void LinearPhaseEQ::prepare(const juce::dsp::ProcessSpec& spec, const ChainCoefficients& coefficients) {
+    release();
+
+    kernelLength = juce::jmax(2 * partitionSize,
+                              juce::nextPowerOfTwo(juce::roundToInt(spec.sampleRate * kernelLengthSeconds)));
+    numPartitions = kernelLength / partitionSize;
+    latencySamples = partitionSize + kernelLength / 2;
+    numChannels = static_cast<size_t>(spec.numChannels);
+
+    auto spectraSize = static_cast<size_t>(numPartitions * numBins * 2);
+
+    designFft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelLength)));
+    designBuffer.resize(static_cast<size_t>(2 * kernelLength));
+    designPartitionBuffer.resize(static_cast<size_t>(4 * partitionSize));
+
+    // The kernel is sampled at the bins of a kernelLength-point FFT, up to Nyquist
+    designFrequencies.resize(static_cast<size_t>(kernelLength / 2 + 1));
+
+    for (size_t bin = 0; bin < designFrequencies.size(); ++bin) {
+        designFrequencies[bin] = static_cast<double>(bin) * spec.sampleRate / kernelLength;
+    }
+
+    designResponseRate = 0.0;
+    designMagnitudes.resize(designFrequencies.size());
+
+    // All three slots, so designs never reallocate - each one pulled straight back, or the
+    // writer would never get to the slot the reader holds
+    for (int i = 0; i < 3; ++i) {
+        kernels.getWriteBuffer().resize(spectraSize);
+        kernels.publish();
+        kernels.pull();
+    }
+
+    kernel.resize(spectraSize);
+    designKernel(coefficients, kernel);
+    incoming = nullptr;
+
+    inputs.resize(numChannels * 2 * partitionSize);
+    history.resize(numChannels * spectraSize);
+    outputs.resize(numChannels * partitionSize);
+    fftBuffer.resize(static_cast<size_t>(4 * partitionSize));
+    fadeBuffer.resize(static_cast<size_t>(partitionSize));
+    reset();
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void LinearPhaseEQ::release() {
+    // The thread sleeps on wake rather than on its own event, which stopThread() would signal
+    signalThreadShouldExit();
+    wake.signal();
+    stopThread(1000);
+}
+
+void LinearPhaseEQ::reset() noexcept {
+    std::fill(inputs.begin(), inputs.end(), 0.f);
+    std::fill(history.begin(), history.end(), 0.f);
+    std::fill(outputs.begin(), outputs.end(), 0.f);
+    historyPosition = 0;
+    position = 0;
+}
+
+void LinearPhaseEQ::setActive(bool shouldBeActive) noexcept {
+    // Coefficients left waiting while inactive are designed as soon as the engine comes back
+    if (!active.exchange(shouldBeActive) && shouldBeActive) {
+        wake.signal();
+    }
+}
+
+void LinearPhaseEQ::setCoefficients(const ChainCoefficients& coefficients) noexcept {
+    targets.getWriteBuffer() = coefficients;
+    targets.publish();
+    wake.signal();
+}
+
+void LinearPhaseEQ::designNow(const ChainCoefficients& coefficients) {
+    const std::lock_guard<std::mutex> lock(designLock);
+
+    designKernel(coefficients, kernels.getWriteBuffer());
+    kernels.publish();
+}
+
+void LinearPhaseEQ::run() {
+    while (!threadShouldExit()) {
+        // While inactive, the newest coefficients are left waiting until they're needed
+        if (active) {
+            if (auto* coefficients = targets.pull()) {
+                designNow(*coefficients);
+            }
+        }
+
+        // Sleeps until new coefficients arrive or the engine becomes active
+        wake.wait();
+    }
+}
+
+void LinearPhaseEQ::designKernel(const ChainCoefficients& coefficients, KernelSpectra& spectra) {
+    // The same sections SIMDBiquadCascade runs
+    std::array<CoefficientArray, maxNumChainSections> biquads;
+    size_t numBiquads = 0;
+
+    forEachActiveSection(coefficients, [&biquads, &numBiquads](size_t, const CoefficientArray& section) {
+        biquads[numBiquads++] = section;
+    });
+
+    if (!juce::approximatelyEqual(coefficients.sampleRate, designResponseRate)) {
+        designResponseRate = coefficients.sampleRate;
+        designResponse.prepare(designFrequencies.data(), designFrequencies.size(), designResponseRate);
+    }
+
+    designResponse.process(biquads.data(), numBiquads, designMagnitudes.data());
+
+    // The magnitudes delayed by half the kernel, e^(-j pi bin), which is just an alternating sign
+    std::fill(designBuffer.begin(), designBuffer.end(), 0.f);
+
+    for (size_t bin = 0; bin < designMagnitudes.size(); ++bin) {
+        auto magnitude = static_cast<float>(juce::Decibels::decibelsToGain(designMagnitudes[bin], -300.0));
+        designBuffer[2 * bin] = (bin % 2 == 0) ? magnitude : -magnitude;
+    }
+
+    designFft->performRealOnlyInverseTransform(designBuffer.data());
+
+    // A Hann window over the whole kernel, centred on the delay, trades the truncation's ripple for
+    // slightly smoother slopes. Its first sample is zero, so the kernel stays exactly symmetric.
+    for (int i = 0; i < kernelLength; ++i) {
+        auto window = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * static_cast<float>(i)
+                                             / static_cast<float>(kernelLength));
+        designBuffer[static_cast<size_t>(i)] *= window;
+    }
+
+    // Each partition zero padded to twice its length, so the last partitionSize samples of every
+    // circular convolution with an input window are exact
+    for (int partition = 0; partition < numPartitions; ++partition) {
+        std::fill(designPartitionBuffer.begin(), designPartitionBuffer.end(), 0.f);
+        std::copy_n(designBuffer.data() + partition * partitionSize, partitionSize, designPartitionBuffer.data());
+
+        designPartitionFft.performRealOnlyForwardTransform(designPartitionBuffer.data(), true);
+        std::copy_n(designPartitionBuffer.data(), 2 * numBins, spectra.data() + partition * numBins * 2);
+    }
+}
+
+void LinearPhaseEQ::process(const juce::dsp::AudioBlock<float>& block) noexcept {
+    auto numSamples = static_cast<int>(block.getNumSamples());
+    auto channelsToProcess = juce::jmin(block.getNumChannels(), numChannels);
+
+    for (int start = 0; start < numSamples;) {
+        auto numToCopy = juce::jmin(numSamples - start, partitionSize - position);
+
+        // In goes the newest input, out comes the output of the partition before
+        for (size_t channel = 0; channel < channelsToProcess; ++channel) {
+            auto* samples = block.getChannelPointer(channel) + start;
+            auto* input = inputs.data() + channel * 2 * partitionSize + partitionSize + position;
+            auto* output = outputs.data() + channel * partitionSize + position;
+
+            std::copy_n(samples, numToCopy, input);
+            std::copy_n(output, numToCopy, samples);
+        }
+
+        start += numToCopy;
+        position += numToCopy;
+
+        if (position == partitionSize) {
+            processPartition();
+            position = 0;
+        }
+    }
+}
+
+void LinearPhaseEQ::processPartition() noexcept {
+    // A new kernel is only taken at a partition boundary, and kept until it's been faded in
+    if (incoming == nullptr) {
+        incoming = kernels.pull();
+    }
+
+    const auto spectrumSize = static_cast<size_t>(numBins * 2);
+    const auto historySize = spectrumSize * static_cast<size_t>(numPartitions);
+
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        auto* input = inputs.data() + channel * 2 * partitionSize;
+        auto* channelHistory = history.data() + channel * historySize;
+        auto* output = outputs.data() + channel * partitionSize;
+
+        // The spectrum of the last two partitions of input joins the history
+        std::copy_n(input, 2 * partitionSize, fftBuffer.data());
+        partitionFft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy_n(fftBuffer.data(), spectrumSize, channelHistory + static_cast<size_t>(historyPosition) * spectrumSize);
+        std::copy_n(input + partitionSize, partitionSize, input);
+
+        convolve(channelHistory, kernel, output);
+
+        if (incoming != nullptr) {
+            convolve(channelHistory, *incoming, fadeBuffer.data());
+
+            for (int i = 0; i < partitionSize; ++i) {
+                auto fade = (static_cast<float>(i) + 0.5f) / static_cast<float>(partitionSize);
+                output[i] += fade * (fadeBuffer[static_cast<size_t>(i)] - output[i]);
+            }
+        }
+    }
+
+    // Faded in, the new kernel takes over by swapping storage with the old one - every slot is the
+    // same size, so the design thread gets back a kernel it can overwrite without reallocating
+    if (incoming != nullptr) {
+        kernel.swap(*incoming);
+        incoming = nullptr;
+    }
+
+    historyPosition = (historyPosition + 1) % numPartitions;
+}
+
+void LinearPhaseEQ::convolve(const float* channelHistory, const KernelSpectra& spectra, float* output) noexcept {
+    const auto spectrumSize = static_cast<size_t>(numBins * 2);
+    auto* accumulator = fftBuffer.data();
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.f);
+
+    // Kernel partition p meets the input spectrum from p partitions ago
+    for (int partition = 0; partition < numPartitions; ++partition) {
+        auto delayed = (historyPosition - partition + numPartitions) % numPartitions;
+        const auto* x = channelHistory + static_cast<size_t>(delayed) * spectrumSize;
+        const auto* h = spectra.data() + static_cast<size_t>(partition) * spectrumSize;
+
+        for (size_t bin = 0; bin < spectrumSize; bin += 2) {
+            accumulator[bin] += x[bin] * h[bin] - x[bin + 1] * h[bin + 1];
+            accumulator[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+        }
+    }
+
+    partitionFft.performRealOnlyInverseTransform(accumulator);
+
+    // Overlap-save: the first half wraps around, the second half is the output
+    std::copy_n(accumulator + partitionSize, partitionSize, output);
+}
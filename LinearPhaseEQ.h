@@ -0,0 +1,95 @@
+#pragma once
+
+#include "FrequencyResponse.h"
+#include "TripleBuffer.h"
+#include "WakeSignal.h"
+
+// The chain as a linear-phase FIR instead of SIMDBiquadCascade's minimum-phase biquads.
+// The kernel has the chain's magnitude response and a constant delay of half its length, and
+// is run with uniformly partitioned overlap-save FFT convolution, so the cost per sample grows
+// with the number of partitions rather than with the kernel length.
+// Kernels are designed on a background thread from the ChainCoefficients the processor passes
+// in, and each new kernel is crossfaded in over one partition. Coefficients designed for an
+// oversampled cascade are evaluated at their own rate, so the kernel gets their unwarped response.
+class LinearPhaseEQ final : private juce::Thread {
+public:
+    // Samples per partition - also the crossfade length and part of the latency. Each partition
+    // is transformed with twice as many points, for overlap-save.
+    static constexpr int partitionFftOrder = 10;
+    static constexpr int partitionSize = 1 << (partitionFftOrder - 1);
+
+    LinearPhaseEQ();
+    ~LinearPhaseEQ() override;
+
+    // Not thread safe against process() - call from prepareToPlay only.
+    // Designs the kernel for coefficients before (re)starting the design thread.
+    void prepare(const juce::dsp::ProcessSpec& spec, const ChainCoefficients& coefficients);
+    void release();
+
+    // Delay in samples added by the kernel and the partitioning
+    int getLatencySamples() const { return latencySamples; }
+    // How long an impulse takes to come out the other end entirely, in samples
+    int getTailSamples() const { return partitionSize + kernelLength; }
+
+    // Audio thread - clears all history, so the next output starts from silence
+    void reset() noexcept;
+
+    // Audio thread - new coefficients are only designed while the engine is active
+    void setActive(bool shouldBeActive) noexcept;
+
+    // Audio thread - hands new coefficients to the design thread
+    void setCoefficients(const ChainCoefficients& coefficients) noexcept;
+
+    // Designs the kernel for coefficients on the calling thread, for offline renders where the
+    // kernel has to follow automation exactly. Not real-time safe.
+    void designNow(const ChainCoefficients& coefficients);
+
+    // Processes min(block channels, prepared channels) channels in place
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+    // One spectrum of numBins interleaved complex values per partition
+    using KernelSpectra = std::vector<float>;
+
+    void run() override;
+    void designKernel(const ChainCoefficients& coefficients, KernelSpectra& spectra);
+    void processPartition() noexcept;
+    // Sum over the partitions of kernel * delayed input spectrum, transformed back to time
+    void convolve(const float* channelHistory, const KernelSpectra& spectra, float* output) noexcept;
+
+    // How long a kernel is, in seconds - rounded up to a power-of-two number of samples
+    static constexpr double kernelLengthSeconds = 0.17;
+    static constexpr int numBins = partitionSize + 1;
+
+    int kernelLength {0}, numPartitions {0}, latencySamples {0};
+    size_t numChannels {0};
+
+    // Design thread side
+    TripleBuffer<ChainCoefficients> targets;
+    TripleBuffer<KernelSpectra> kernels;
+    std::mutex designLock;
+    std::unique_ptr<juce::dsp::FFT> designFft;
+    juce::dsp::FFT designPartitionFft {partitionFftOrder};
+    std::vector<float> designPartitionBuffer;
+    std::vector<float> designBuffer;
+    // The kernel's bins in Hz, and the rate designResponse was last prepared for
+    std::vector<double> designFrequencies;
+    double designResponseRate {0.0};
+    FrequencyResponse designResponse;
+    std::vector<double> designMagnitudes;
+    std::atomic<bool> active {false};
+    // Signalled from the audio thread whenever there may be something new to design
+    WakeSignal wake;
+
+    // Audio thread side
+    juce::dsp::FFT partitionFft {partitionFftOrder};
+    KernelSpectra kernel;
+    KernelSpectra* incoming {nullptr};
+    // Per channel: the last two partitions of input, the spectra of the last numPartitions
+    // input partitions, and the output of the last partition processed
+    std::vector<float> inputs, history, outputs;
+    int historyPosition {0}, position {0};
+    std::vector<float> fftBuffer, fadeBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEQ)
+};
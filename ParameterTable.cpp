@@ -0,0 +1,132 @@
+#include "ParameterTable.h"
+#include "RealtimeChecks.h"
+
+ParameterTable::ParameterTable(juce::AudioProcessorValueTreeState& state)
+    : apvts(state),
+      lowCutFreq(makeHandle("LowCut Freq")),
+      highCutFreq(makeHandle("HighCut Freq")),
+      lowCutSlope(makeHandle("LowCut Slope")),
+      highCutSlope(makeHandle("HighCut Slope")),
+      filterDesign(makeHandle("Filter Design")),
+      lowCutBypassed(makeHandle("LowCut Bypassed")),
+      highCutBypassed(makeHandle("HighCut Bypassed")),
+      bypass(makeHandle("Bypass")),
+      oversampling(makeHandle("Oversampling")),
+      smoothingTime(makeHandle("Smoothing Time")),
+      topology(makeHandle("Filter Topology")),
+      phaseMode(makeHandle("Phase Mode")),
+      morph(makeHandle("Morph")),
+      morphTarget(makeHandle("Morph Target")) {
+    const auto& peakParameterIDs = getPeakParameterIDs();
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        const auto& ids = peakParameterIDs[band];
+        peaks[band] = {makeHandle(ids.freq), makeHandle(ids.gain), makeHandle(ids.quality),
+                       makeHandle(ids.type), makeHandle(ids.bypassed)};
+    }
+
+    for (auto* param : apvts.processor.getParameters()) {
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param)) {
+            apvts.addParameterListener(rangedParam->getParameterID(), this);
+        }
+    }
+}
+
+ParameterTable::~ParameterTable() {
+    for (auto* param : apvts.processor.getParameters()) {
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param)) {
+            apvts.removeParameterListener(rangedParam->getParameterID(), this);
+        }
+    }
+}
+
+ParameterTable::Handle ParameterTable::makeHandle(const juce::String& parameterID) const {
+    auto* parameter = apvts.getParameter(parameterID);
+    jassert(parameter != nullptr);
+
+    return {apvts.getRawParameterValue(parameterID),
+            parameter != nullptr ? static_cast<size_t>(parameter->getParameterIndex()) : 0};
+}
+
+void ParameterTable::parameterChanged(const juce::String& parameterID, float newValue) {
+    juce::ignoreUnused(parameterID, newValue);
+
+    // Called on whichever thread set the parameter - anywhere but the message thread, that's the
+    // audio thread under host automation, and in builds with SIMPLEEQ_REALTIME_CHECKS anything
+    // below that allocates or locks is recorded as it is in processBlock
+    const ScopedRealtimeGuard realtimeGuard(!juce::MessageManager::existsAndIsCurrentThread());
+    bumpGeneration();
+}
+
+void ParameterTable::bumpGeneration() noexcept {
+    generation.fetch_add(1, std::memory_order_acq_rel);
+
+    if (auto* changeListener = listener.load()) {
+        changeListener->parametersChanged();
+    }
+}
+
+template<typename Read>
+ChainSettings ParameterTable::readChainSettings(Read&& read) const {
+    ChainSettings chainSettings;
+
+    chainSettings.lowCutFreq = read(lowCutFreq);
+    chainSettings.highCutFreq = read(highCutFreq);
+    chainSettings.lowCutSlope = static_cast<Slope>(read(lowCutSlope));
+    chainSettings.highCutSlope = static_cast<Slope>(read(highCutSlope));
+    chainSettings.filterDesign = static_cast<FilterDesign>(read(filterDesign));
+
+    auto bypassed = read(bypass) > 0.5f;
+    chainSettings.lowCutMix = bypassed || read(lowCutBypassed) > 0.5f ? 0.f : 1.f;
+    chainSettings.highCutMix = bypassed || read(highCutBypassed) > 0.5f ? 0.f : 1.f;
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        const auto& handles = peaks[band];
+        auto& peak = chainSettings.peaks[band];
+
+        peak.freq = read(handles.freq);
+        peak.gainInDecibels = read(handles.gain);
+        peak.quality = read(handles.quality);
+        peak.type = static_cast<PeakType>(read(handles.type));
+        peak.mix = bypassed || read(handles.bypassed) > 0.5f ? 0.f : 1.f;
+    }
+
+    return chainSettings;
+}
+
+ChainSettings ParameterTable::getChainSettings() const noexcept {
+    auto chainSettings = readChainSettings([](const Handle& handle) { return handle.value->load(); });
+    auto amount = morph.value->load();
+
+    if (amount > 0.f) {
+        auto target = static_cast<size_t>(juce::jlimit(0, numPrograms - 1, juce::roundToInt(morphTarget.value->load())));
+        auto targetSettings = programSettings.read([target](const auto& settings) { return settings[target]; });
+
+        chainSettings = interpolateChainSettings(chainSettings, targetSettings, amount);
+    }
+
+    return chainSettings;
+}
+
+ChainSettings ParameterTable::getChainSettings(const std::vector<float>& values) const {
+    return readChainSettings([&values](const Handle& handle) { return values.at(handle.index); });
+}
+
+double ParameterTable::getProcessingSampleRate(const std::vector<float>& values, double sampleRate) const {
+    return sampleRate * static_cast<double>(1 << juce::roundToInt(values.at(oversampling.index)));
+}
+
+void ParameterTable::setProgramSettings(int index, const ChainSettings& chainSettings) {
+    programSettings.modify([index, &chainSettings](auto& settings) {
+        settings[static_cast<size_t>(index)] = chainSettings;
+    });
+
+    // Whatever is morphing towards it has to be designed again
+    bumpGeneration();
+}
+
+double ParameterTable::getProcessingSampleRate(double sampleRate) const noexcept {
+    // "Off", "2x", "4x"
+    auto factorLog2 = juce::roundToInt(oversampling.value->load());
+    return sampleRate * static_cast<double>(1 << factorLog2);
+}
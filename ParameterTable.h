@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+#include "SnapshotBuffer.h"
+
+// Every parameter the processor reads, as the std::atomic<float>s behind them - looked up by ID
+// once, so reading a whole ChainSettings is a few dozen loads rather than as many hashed lookups.
+// Each change to any of apvts's parameters also bumps a generation count, so a reader that keeps
+// the generation it last read at can tell whether anything moved without reading anything else.
+class ParameterTable final : private juce::AudioProcessorValueTreeState::Listener {
+public:
+    // Told after every bump of the generation, on the thread that made the change - the audio
+    // thread included, so it mustn't block
+    struct Listener {
+        virtual ~Listener() = default;
+        virtual void parametersChanged() noexcept = 0;
+    };
+
+    explicit ParameterTable(juce::AudioProcessorValueTreeState& apvts);
+    ~ParameterTable() override;
+
+    // Message thread, before anything can change the parameters or after nothing can any more
+    void setListener(Listener* newListener) noexcept { listener = newListener; }
+
+    // Any thread. Bumped after the new value is stored, so reading the generation before the
+    // values never misses a change - at worst a change is seen twice.
+    juce::uint32 getGeneration() const noexcept { return generation.load(std::memory_order_acquire); }
+    bool hasChangedSince(juce::uint32 lastGeneration) const noexcept { return getGeneration() != lastGeneration; }
+
+    // Any thread - the settings the parameters describe, blended towards the "Morph Target"
+    // program's by "Morph". Never locks, the program's settings are read from a snapshot.
+    ChainSettings getChainSettings() const noexcept;
+    // The settings a full set of parameter values describes, in getParameters() order and the
+    // parameters' own units - as programs store them
+    ChainSettings getChainSettings(const std::vector<float>& values) const;
+    double getProcessingSampleRate(const std::vector<float>& values, double sampleRate) const;
+
+    // Message thread - the settings of the program "Morph" blends towards when it's the target
+    void setProgramSettings(int index, const ChainSettings& chainSettings);
+
+    // Any thread - none of these allocate or lock
+    // The rate the cascade is designed for and runs at - sampleRate times the "Oversampling" factor
+    double getProcessingSampleRate(double sampleRate) const noexcept;
+    // "Smoothing Time", in milliseconds
+    float getSmoothingTime() const noexcept { return smoothingTime.value->load(); }
+    FilterTopology getTopology() const noexcept { return static_cast<FilterTopology>(topology.value->load()); }
+    bool isLinearPhase() const noexcept { return phaseMode.value->load() > 0.5f; }
+    // "Bypass", the whole plugin's
+    bool isBypassed() const noexcept { return bypass.value->load() > 0.5f; }
+
+private:
+    // A parameter's value, and where it sits in getParameters() and so in stored values
+    struct Handle {
+        std::atomic<float>* value {nullptr};
+        size_t index {0};
+    };
+
+    struct PeakHandles {
+        Handle freq, gain, quality, type, bypassed;
+    };
+
+    Handle makeHandle(const juce::String& parameterID) const;
+    void bumpGeneration() noexcept;
+    // The settings with every value read through read(handle)
+    template<typename Read>
+    ChainSettings readChainSettings(Read&& read) const;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    Handle lowCutFreq, highCutFreq, lowCutSlope, highCutSlope, filterDesign;
+    Handle lowCutBypassed, highCutBypassed, bypass;
+    std::array<PeakHandles, numPeakBands> peaks;
+
+    Handle oversampling, smoothingTime, topology, phaseMode;
+    Handle morph, morphTarget;
+
+    SnapshotBuffer<std::array<ChainSettings, numPrograms>> programSettings;
+
+    std::atomic<juce::uint32> generation {0};
+    std::atomic<Listener*> listener {nullptr};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterTable)
+};
@@ -0,0 +1,144 @@
+#include "PresetBank.h"
+
+namespace {
+struct FactoryProgram {
+    const char* name;
+    // Parameters that differ from their defaults, by ID
+    std::vector<std::pair<const char*, float>> values;
+};
+
+// Choice parameters take the index of their choice - slopes are 12/24/36/48 dB/Oct, peak types
+// Bell/Low Shelf/High Shelf/Notch
+const std::array<FactoryProgram, numPrograms>& getFactoryPrograms() {
+    static const std::array<FactoryProgram, numPrograms> factoryPrograms {{
+        {"Flat", {}},
+        {"Rumble Filter", {{"LowCut Freq", 40.f}, {"LowCut Slope", 3.f}}},
+        {"Vocal Presence", {{"LowCut Freq", 90.f}, {"LowCut Slope", 1.f},
+                            {"Peak Freq", 3000.f}, {"Peak Gain", 3.f}, {"Peak Quality", 1.f},
+                            {"Peak 2 Freq", 250.f}, {"Peak 2 Gain", -2.f}, {"Peak 2 Quality", 1.f}}},
+        {"Air", {{"Peak Type", 2.f}, {"Peak Freq", 10000.f}, {"Peak Gain", 4.f}, {"Peak Quality", 0.7f}}},
+        {"Warmth", {{"Peak Type", 1.f}, {"Peak Freq", 200.f}, {"Peak Gain", 3.f}, {"Peak Quality", 0.7f},
+                    {"HighCut Freq", 14000.f}}},
+        {"De-Mud", {{"Peak Freq", 350.f}, {"Peak Gain", -4.f}, {"Peak Quality", 1.4f}}},
+        {"Telephone", {{"LowCut Freq", 400.f}, {"LowCut Slope", 3.f}, {"HighCut Freq", 3400.f}, {"HighCut Slope", 3.f}}},
+        {"Hum Notch", {{"Peak Type", 3.f}, {"Peak Freq", 50.f}, {"Peak Quality", 10.f},
+                       {"Peak 2 Type", 3.f}, {"Peak 2 Freq", 100.f}, {"Peak 2 Quality", 10.f}}},
+    }};
+
+    return factoryPrograms;
+}
+
+juce::RangedAudioParameter& getRangedParameter(const juce::AudioProcessor& processor, int index) {
+    auto* rangedParameter = dynamic_cast<juce::RangedAudioParameter*>(processor.getParameters()[index]);
+    jassert(rangedParameter != nullptr);
+    return *rangedParameter;
+}
+
+int findParameterIndex(const juce::AudioProcessor& processor, const juce::String& parameterID) {
+    for (int i = 0; i < processor.getParameters().size(); ++i) {
+        if (getRangedParameter(processor, i).getParameterID() == parameterID) {
+            return i;
+        }
+    }
+
+    jassertfalse;
+    return -1;
+}
+}
+
+PresetBank::PresetBank(juce::AudioProcessor& p, ParameterTable& table)
+    : processor(p), parameters(table),
+      bypassIndex(findParameterIndex(processor, "Bypass")),
+      morphIndex(findParameterIndex(processor, "Morph")),
+      morphTargetIndex(findParameterIndex(processor, "Morph Target")) {
+    const auto& factoryPrograms = getFactoryPrograms();
+
+    for (size_t program = 0; program < programs.size(); ++program) {
+        auto values = getDefaultValues();
+
+        for (const auto& [parameterID, value] : factoryPrograms[program].values) {
+            auto index = findParameterIndex(processor, parameterID);
+
+            if (index >= 0) {
+                values[static_cast<size_t>(index)] = value;
+            }
+        }
+
+        programs[program].name = factoryPrograms[program].name;
+        setValues(static_cast<int>(program), std::move(values));
+    }
+}
+
+void PresetBank::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+
+    for (int index = 0; index < numPrograms; ++index) {
+        design(index);
+    }
+}
+
+void PresetBank::designIfChanged(int index) {
+    if (programs[static_cast<size_t>(index)].changed) {
+        design(index);
+    }
+}
+
+const ChainCoefficients* PresetBank::getCoefficients(int index, double processingRate) noexcept {
+    auto& coefficients = programs[static_cast<size_t>(index)].coefficients;
+    coefficients.pull();
+
+    const auto& designed = coefficients.getReadBuffer();
+    return juce::approximatelyEqual(designed.sampleRate, processingRate) ? &designed : nullptr;
+}
+
+void PresetBank::setValues(int index, std::vector<float> values) {
+    auto defaults = getDefaultValues();
+    auto bypass = static_cast<size_t>(bypassIndex);
+
+    // Parameters added since the values were stored start out at their defaults
+    for (size_t i = values.size(); i < defaults.size(); ++i) {
+        values.push_back(defaults[i]);
+    }
+
+    values.resize(defaults.size());
+    values[bypass] = defaults[bypass];
+
+    auto& program = programs[static_cast<size_t>(index)];
+    program.values = std::move(values);
+    program.changed = true;
+
+    // Morphing blends towards the settings whether or not they have been designed yet
+    parameters.setProgramSettings(index, parameters.getChainSettings(program.values));
+}
+
+bool PresetBank::isRecalled(int parameterIndex) const {
+    return parameterIndex != bypassIndex && parameterIndex != morphIndex && parameterIndex != morphTargetIndex;
+}
+
+std::vector<float> PresetBank::getDefaultValues() const {
+    std::vector<float> values;
+
+    for (int i = 0; i < processor.getParameters().size(); ++i) {
+        auto& rangedParameter = getRangedParameter(processor, i);
+        values.push_back(rangedParameter.convertFrom0to1(rangedParameter.getDefaultValue()));
+    }
+
+    return values;
+}
+
+void PresetBank::design(int index) {
+    auto& program = programs[static_cast<size_t>(index)];
+
+    // Until prepared, there's no rate to design for - prepare() designs every program anyway
+    if (sampleRate <= 0.0) {
+        return;
+    }
+
+    // The write buffer still holds what was designed two publishes ago, so only the bands that
+    // differ from that are designed again
+    auto& coefficients = program.coefficients.getWriteBuffer();
+    updateChainCoefficients(coefficients, parameters.getChainSettings(program.values),
+                            parameters.getProcessingSampleRate(program.values, sampleRate));
+    program.coefficients.publish();
+    program.changed = false;
+}
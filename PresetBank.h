@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ParameterTable.h"
+#include "TripleBuffer.h"
+
+// The processor's programs - each a full set of parameter values, together with the chain's
+// coefficients already designed for them at the rate it runs at. Switching programs then only
+// hands the audio thread a pointer to finished coefficients instead of redesigning every band,
+// and each program's settings are kept in parameters for "Morph" to blend towards.
+class PresetBank final {
+public:
+    // Starts out with the factory programs
+    PresetBank(juce::AudioProcessor& processor, ParameterTable& parameters);
+
+    // Not thread safe against getCoefficients() - call from prepareToPlay only.
+    // Designs every program's coefficients for the host's sampleRate.
+    void prepare(double sampleRate);
+    // Message thread - designs the program's coefficients if its values changed since they were
+    // last designed, so it's ready before the audio thread is told to switch to it
+    void designIfChanged(int index);
+
+    // Audio thread - the program's coefficients, or nullptr if they weren't designed for processingRate
+    const ChainCoefficients* getCoefficients(int index, double processingRate) noexcept;
+
+    // Message thread - values are in getParameters() order and the parameters' own units
+    const std::vector<float>& getValues(int index) const { return programs[static_cast<size_t>(index)].values; }
+    // Missing values are filled in with the parameters' defaults, and "Bypass" is always stored
+    // off - a program bypassed when it's stored would come back bypassed otherwise. Only the
+    // settings "Morph" blends towards are updated here, the coefficients wait for
+    // designIfChanged() - loading a state sets every program, and most are never switched to.
+    void setValues(int index, std::vector<float> values);
+
+    const juce::String& getName(int index) const { return programs[static_cast<size_t>(index)].name; }
+    void setName(int index, const juce::String& name) { programs[static_cast<size_t>(index)].name = name; }
+
+    // Whether a program sets the parameter when it's recalled - the bypass and morph controls
+    // are part of the performance rather than of any one program, and keep their values
+    bool isRecalled(int parameterIndex) const;
+
+private:
+    struct Program {
+        juce::String name;
+        std::vector<float> values;
+        // Published by design(), read on the audio thread
+        TripleBuffer<ChainCoefficients> coefficients;
+        // Whether values changed since coefficients were last designed
+        bool changed {true};
+    };
+
+    void design(int index);
+    std::vector<float> getDefaultValues() const;
+
+    juce::AudioProcessor& processor;
+    ParameterTable& parameters;
+    std::array<Program, numPrograms> programs;
+    double sampleRate {0.0};
+    // Indices of the parameters programs don't recall
+    int bypassIndex, morphIndex, morphTargetIndex;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
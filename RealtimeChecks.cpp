@@ -0,0 +1,229 @@
+#include "RealtimeChecks.h"
+
+#if SIMPLEEQ_REALTIME_CHECKS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <pthread.h>
+ #include <unistd.h>
+#endif
+
+enum class ViolationKind { allocation, deallocation, mutexLock };
+
+static constexpr int maxFrames = 32;
+static constexpr int maxRecordedViolations = 64;
+
+struct Violation {
+    ViolationKind kind {ViolationKind::allocation};
+    int numFrames {0};
+    void* frames[maxFrames] {};
+};
+
+static Violation violations[maxRecordedViolations];
+static std::atomic<int> numViolations {0};
+static std::atomic<bool> abortOnViolation {false};
+
+// Initial-exec so reading them never allocates, which would recurse straight back into malloc
+[[gnu::tls_model("initial-exec")]] static thread_local int guardDepth = 0;
+[[gnu::tls_model("initial-exec")]] static thread_local bool isRecording = false;
+
+static const char* getDescription(ViolationKind kind) noexcept {
+    switch (kind) {
+        case ViolationKind::allocation: return "allocation";
+        case ViolationKind::deallocation: return "deallocation";
+        case ViolationKind::mutexLock: return "mutex lock";
+    }
+
+    return "";
+}
+
+// Must not allocate or lock itself - isRecording lets anything backtrace() needs on its first call through
+static void recordViolation(ViolationKind kind) noexcept {
+    if (guardDepth == 0 || isRecording) {
+        return;
+    }
+
+    isRecording = true;
+    auto index = numViolations.fetch_add(1);
+
+#if JUCE_LINUX
+    if (abortOnViolation.load()) {
+        void* frames[maxFrames];
+        auto numFrames = backtrace(frames, maxFrames);
+        auto* description = getDescription(kind);
+
+        juce::ignoreUnused(write(STDERR_FILENO, "Real-time violation: ", 21));
+        juce::ignoreUnused(write(STDERR_FILENO, description, strlen(description)));
+        juce::ignoreUnused(write(STDERR_FILENO, "\n", 1));
+        backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+        std::abort();
+    }
+
+    if (index < maxRecordedViolations) {
+        auto& violation = violations[index];
+        violation.kind = kind;
+        violation.numFrames = backtrace(violation.frames, maxFrames);
+    }
+#else
+    juce::ignoreUnused(index);
+#endif
+
+    isRecording = false;
+}
+
+ScopedRealtimeGuard::ScopedRealtimeGuard(bool isActive) noexcept : active(isActive) {
+    if (active) {
+        ++guardDepth;
+    }
+}
+
+ScopedRealtimeGuard::~ScopedRealtimeGuard() noexcept {
+    if (active) {
+        --guardDepth;
+    }
+}
+
+int getNumRealtimeViolations() noexcept {
+    return numViolations.load();
+}
+
+juce::String getRealtimeViolationReport() {
+    jassert(guardDepth == 0);
+
+    juce::String report;
+    auto numRecorded = juce::jmin(numViolations.load(), maxRecordedViolations);
+
+    for (int i = 0; i < numRecorded; ++i) {
+        const auto& violation = violations[i];
+        report << "Real-time violation " << (i + 1) << ": " << getDescription(violation.kind) << "\n";
+
+#if JUCE_LINUX
+        if (auto* symbols = backtrace_symbols(violation.frames, violation.numFrames)) {
+            for (int frame = 0; frame < violation.numFrames; ++frame) {
+                report << "    " << symbols[frame] << "\n";
+            }
+
+            std::free(symbols);
+        }
+#endif
+    }
+
+    if (numViolations.load() > numRecorded) {
+        report << (numViolations.load() - numRecorded) << " more without a backtrace\n";
+    }
+
+    return report;
+}
+
+void clearRealtimeViolations() noexcept {
+    numViolations = 0;
+}
+
+void setAbortOnRealtimeViolation(bool shouldAbort) noexcept {
+    abortOnViolation = shouldAbort;
+}
+
+#if JUCE_LINUX
+// glibc's own entry points, which the interposed functions below forward to once they've recorded
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+}
+
+extern "C" void* malloc(size_t size) noexcept {
+    recordViolation(ViolationKind::allocation);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) noexcept {
+    recordViolation(ViolationKind::allocation);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) noexcept {
+    recordViolation(ViolationKind::allocation);
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+    recordViolation(ViolationKind::allocation);
+    *result = __libc_memalign(alignment, size);
+    return *result != nullptr || size == 0 ? 0 : ENOMEM;
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    recordViolation(ViolationKind::allocation);
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void free(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        recordViolation(ViolationKind::deallocation);
+    }
+
+    __libc_free(pointer);
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    using LockFunction = int (*)(pthread_mutex_t*);
+
+    // Not a function-local static, its initialisation guard may lock a mutex itself
+    static std::atomic<LockFunction> realLock {nullptr};
+    auto lock = realLock.load(std::memory_order_relaxed);
+
+    if (lock == nullptr) {
+        lock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        realLock.store(lock, std::memory_order_relaxed);
+    }
+
+    recordViolation(ViolationKind::mutexLock);
+    return lock(mutex);
+}
+
+// operator new/delete only have to go through the interposed functions above
+static void* allocate(size_t size) {
+    if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+static void* allocateAligned(size_t size, std::align_val_t alignment) {
+    if (auto* pointer = aligned_alloc(static_cast<size_t>(alignment), size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return std::malloc(size == 0 ? 1 : size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return std::malloc(size == 0 ? 1 : size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Opt-in (SIMPLEEQ_REALTIME_CHECKS) detection of calls that aren't real-time safe.
+// While a ScopedRealtimeGuard is alive on a thread, every malloc/calloc/realloc/free,
+// operator new/delete and pthread_mutex_lock made on that thread is recorded with its backtrace.
+// The calls are caught by interposing the libc functions, so this only reports on Linux.
+// Without the option the guard compiles to nothing.
+
+#ifndef SIMPLEEQ_REALTIME_CHECKS
+ #define SIMPLEEQ_REALTIME_CHECKS 0
+#endif
+
+class ScopedRealtimeGuard {
+public:
+#if SIMPLEEQ_REALTIME_CHECKS
+    explicit ScopedRealtimeGuard(bool isActive = true) noexcept;
+    ~ScopedRealtimeGuard() noexcept;
+
+private:
+    const bool active;
+#else
+    explicit ScopedRealtimeGuard(bool isActive = true) noexcept { juce::ignoreUnused(isActive); }
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeGuard)
+};
+
+#if SIMPLEEQ_REALTIME_CHECKS
+// Counts every violation, though only the first few keep their backtrace
+int getNumRealtimeViolations() noexcept;
+
+// Call outside any guard, symbolising the backtraces allocates
+juce::String getRealtimeViolationReport();
+
+void clearRealtimeViolations() noexcept;
+
+// Prints the backtrace to stderr and aborts on the next violation instead of recording it
+void setAbortOnRealtimeViolation(bool shouldAbort) noexcept;
+#endif
@@ -0,0 +1,188 @@
+#include "RenderScheduler.h"
+
+#include <iostream>
+
+// Renders audio files through SimpleEQAudioProcessor without a host:
+//
+//   SimpleEQRender [--state <file>] [--set "<parameter id>=<value>"]... [--save-state <file>]
+//                  [--block-size <samples>] [--jobs <workers>] [--chunk-seconds <seconds>]
+//                  [--output-dir <dir>] <input file>...
+//
+// --state loads a blob in the getStateInformation format, --set then overrides single parameters
+// in their real units (choice parameters take the choice index), e.g. --set "LowCut Freq=80".
+// Every input is written as <name>_eq.<ext> with its own format and bit depth, next to the input
+// unless an output directory is given. Files are rendered in parallel by RenderScheduler, with
+// one worker per CPU unless --jobs says otherwise, and files longer than --chunk-seconds are split.
+
+struct RenderSettings {
+    juce::File stateFile, saveStateFile, outputDirectory;
+    juce::StringPairArray parameterOverrides;
+    RenderScheduler::Options schedulerOptions;
+    juce::Array<juce::File> inputFiles;
+};
+
+static void printUsage() {
+    std::cerr << "usage: SimpleEQRender [--state <file>] [--set \"<parameter id>=<value>\"]... "
+                 "[--save-state <file>] [--block-size <samples>] [--jobs <workers>] [--chunk-seconds <seconds>] "
+                 "[--output-dir <dir>] <input file>...\n";
+}
+
+static bool parseArguments(const juce::StringArray& args, RenderSettings& settings) {
+    for (int i = 0; i < args.size(); ++i) {
+        const auto& arg = args[i];
+        auto hasValue = i + 1 < args.size();
+
+        if (arg.startsWith("--") && !hasValue) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+
+        if (arg == "--state") {
+            settings.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        } else if (arg == "--save-state") {
+            settings.saveStateFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        } else if (arg == "--output-dir") {
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        } else if (arg == "--block-size") {
+            settings.schedulerOptions.blockSize = args[++i].getIntValue();
+
+            if (settings.schedulerOptions.blockSize <= 0) {
+                std::cerr << "invalid block size " << args[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--jobs") {
+            settings.schedulerOptions.numWorkers = args[++i].getIntValue();
+
+            if (settings.schedulerOptions.numWorkers <= 0) {
+                std::cerr << "invalid number of jobs " << args[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--chunk-seconds") {
+            settings.schedulerOptions.chunkSeconds = args[++i].getDoubleValue();
+
+            if (settings.schedulerOptions.chunkSeconds <= 0.0) {
+                std::cerr << "invalid chunk length " << args[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--set") {
+            const auto& assignment = args[++i];
+
+            if (!assignment.containsChar('=')) {
+                std::cerr << "expected \"<parameter id>=<value>\", got " << assignment << "\n";
+                return false;
+            }
+
+            settings.parameterOverrides.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                            assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        } else if (arg.startsWith("--")) {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        } else {
+            settings.inputFiles.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+        }
+    }
+
+    return true;
+}
+
+static bool applyParameterOverrides(SimpleEQAudioProcessor& processor, const juce::StringPairArray& overrides) {
+    for (const auto& parameterID : overrides.getAllKeys()) {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+
+        if (parameter == nullptr) {
+            std::cerr << "unknown parameter \"" << parameterID << "\"\n";
+            return false;
+        }
+
+        auto value = overrides[parameterID].getFloatValue();
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    return true;
+}
+
+static juce::File getOutputFile(const juce::File& inputFile, const juce::File& outputDirectory) {
+    auto directory = outputDirectory == juce::File() ? inputFile.getParentDirectory() : outputDirectory;
+    return directory.getChildFile(inputFile.getFileNameWithoutExtension() + "_eq" + inputFile.getFileExtension());
+}
+
+static void printResult(const RenderScheduler::RunResult& result) {
+    for (const auto& file : result.files) {
+        if (file.error.isNotEmpty()) {
+            std::cerr << file.inputFile.getFullPathName() << ": " << file.error << "\n";
+        } else {
+            std::cout << file.inputFile.getFileName() << "\t" << file.numSamples << " samples\tdone after "
+                      << file.latencySeconds << " s\n";
+        }
+    }
+
+    auto samplesPerSecond = [&result](double seconds) {
+        return seconds > 0.0 ? static_cast<double>(result.numSamples) / seconds : 0.0;
+    };
+
+    std::cout << "total\t" << result.numSamples << " samples in " << result.wallSeconds << " s\t"
+              << samplesPerSecond(result.wallSeconds) << " samples/s including I/O\t"
+              << samplesPerSecond(result.processSeconds) << " samples/s per worker in processBlock\n";
+}
+
+int main(int argc, char* argv[]) {
+    RenderSettings settings;
+    settings.schedulerOptions.numWorkers = juce::SystemStats::getNumCpus();
+
+    if (!parseArguments(juce::StringArray(argv + 1, argc - 1), settings)
+        || (settings.inputFiles.isEmpty() && settings.saveStateFile == juce::File())) {
+        printUsage();
+        return 1;
+    }
+
+    // The message loop never runs, the MessageManager only has to exist because the parameter
+    // state's timer registers with it
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    SimpleEQAudioProcessor processor;
+
+    if (settings.stateFile != juce::File()) {
+        juce::MemoryBlock state;
+
+        if (!settings.stateFile.loadFileAsData(state)) {
+            std::cerr << settings.stateFile.getFullPathName() << ": can't be read\n";
+            return 1;
+        }
+
+        processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    }
+
+    if (!applyParameterOverrides(processor, settings.parameterOverrides))
+        return 1;
+
+    juce::MemoryBlock state;
+    processor.getStateInformation(state);
+
+    if (settings.saveStateFile != juce::File()) {
+        if (!settings.saveStateFile.replaceWithData(state.getData(), state.getSize())) {
+            std::cerr << settings.saveStateFile.getFullPathName() << ": can't be written\n";
+            return 1;
+        }
+    }
+
+    if (settings.inputFiles.isEmpty())
+        return 0;
+
+    // Enough I/O threads that reading ahead and writing behind keep up with the workers
+    settings.schedulerOptions.numIOThreads = juce::jmax(1, settings.schedulerOptions.numWorkers / 8);
+
+    RenderScheduler scheduler(state, settings.schedulerOptions);
+
+    for (const auto& inputFile : settings.inputFiles) {
+        scheduler.addFile(inputFile, getOutputFile(inputFile, settings.outputDirectory));
+    }
+
+    auto result = scheduler.run();
+    printResult(result);
+
+    auto failed = std::any_of(result.files.begin(), result.files.end(), [](const auto& file) {
+        return file.error.isNotEmpty();
+    });
+
+    return failed ? 1 : 0;
+}
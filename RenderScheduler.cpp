@@ -0,0 +1,339 @@
+#include "RenderScheduler.h"
+#include "ParameterTable.h"
+
+#include <map>
+
+struct RenderScheduler::OutputFile {
+    juce::File inputFile, outputFile;
+    FileResult result;
+
+    double sampleRate {0.0};
+    int numChannels {0};
+    juce::int64 lengthInSamples {0};
+    juce::int64 warmUpSamples {0};
+    int numChunks {0};
+
+    // Chunks can finish in any order, they're written in order as soon as the next one is done
+    std::mutex lock;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+    std::map<int, juce::AudioBuffer<float>> finishedChunks;
+    int nextChunkToWrite {0};
+};
+
+struct RenderScheduler::Job {
+    OutputFile* file {nullptr};
+    int chunkIndex {0};
+    juce::int64 start {0}, length {0};
+};
+
+struct RenderScheduler::Worker final : public juce::Thread {
+    Worker(RenderScheduler& o, size_t i) : juce::Thread("SimpleEQ Render Worker " + juce::String(static_cast<int>(i))),
+                                           owner(o), index(i) {
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override {
+        while (auto job = owner.takeJob(*this)) {
+            owner.renderJob(*this, *job);
+        }
+    }
+
+    RenderScheduler& owner;
+    const size_t index;
+    SimpleEQAudioProcessor processor;
+    juce::AudioFormatManager formatManager;
+
+    // The owner works from the front, thieves take from the back
+    std::mutex jobLock;
+    std::deque<Job> jobs;
+
+    juce::int64 numSamples {0};
+    double processSeconds {0.0};
+};
+
+// Long enough for the chain's state to build up as fully as its tail takes to die away
+static juce::int64 getWarmUpSamples(const ChainSettings& chainSettings, double sampleRate) {
+    ChainCoefficients coefficients;
+    updateChainCoefficients(coefficients, chainSettings, sampleRate);
+
+    return static_cast<juce::int64>(std::ceil(getChainTailSeconds(coefficients) * sampleRate));
+}
+
+RenderScheduler::RenderScheduler(const juce::MemoryBlock& processorState, const Options& o) : options(o) {
+    jassert(options.numWorkers > 0 && options.numIOThreads > 0 && options.blockSize > 0);
+
+    formatManager.registerBasicFormats();
+
+    for (int i = 0; i < options.numIOThreads; ++i) {
+        ioThreads.push_back(std::make_unique<juce::TimeSliceThread>("SimpleEQ Render I/O " + juce::String(i)));
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(options.numWorkers); ++i) {
+        workers.push_back(std::make_unique<Worker>(*this, i));
+        workers.back()->processor.setStateInformation(processorState.getData(),
+                                                      static_cast<int>(processorState.getSize()));
+    }
+}
+
+RenderScheduler::~RenderScheduler() {
+    for (auto& worker : workers) {
+        worker->stopThread(-1);
+    }
+
+    // Writers left over from a failed file flush through the I/O threads
+    files.clear();
+
+    for (auto& ioThread : ioThreads) {
+        ioThread->stopThread(-1);
+    }
+}
+
+void RenderScheduler::addFile(const juce::File& inputFile, const juce::File& outputFile) {
+    auto file = std::make_unique<OutputFile>();
+    file->inputFile = inputFile;
+    file->outputFile = outputFile;
+    file->result.inputFile = inputFile;
+    file->result.outputFile = outputFile;
+    files.push_back(std::move(file));
+}
+
+RenderScheduler::RunResult RenderScheduler::run() {
+    for (auto& ioThread : ioThreads) {
+        ioThread->startThread();
+    }
+
+    runStartMs = juce::Time::getMillisecondCounterHiRes();
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        scheduleFile(*files[i], i);
+    }
+
+    // Longest jobs first, dealt round robin, so the tail of the run is made of short jobs
+    std::stable_sort(pendingJobs.begin(), pendingJobs.end(), [](const Job& a, const Job& b) {
+        return a.length > b.length;
+    });
+
+    for (size_t i = 0; i < pendingJobs.size(); ++i) {
+        workers[i % workers.size()]->jobs.push_back(pendingJobs[i]);
+    }
+
+    pendingJobs.clear();
+
+    for (auto& worker : workers) {
+        worker->startThread();
+    }
+
+    for (auto& worker : workers) {
+        worker->waitForThreadToExit(-1);
+    }
+
+    RunResult result;
+    result.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - runStartMs) / 1000.0;
+
+    for (auto& worker : workers) {
+        result.numSamples += worker->numSamples;
+        result.processSeconds += worker->processSeconds;
+    }
+
+    for (auto& file : files) {
+        result.files.push_back(file->result);
+    }
+
+    return result;
+}
+
+void RenderScheduler::scheduleFile(OutputFile& file, size_t fileIndex) {
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file.inputFile));
+
+    if (reader == nullptr) {
+        file.result.error = "not a readable WAV or AIFF file";
+        return;
+    }
+
+    file.sampleRate = reader->sampleRate;
+    file.numChannels = static_cast<int>(reader->numChannels);
+    file.lengthInSamples = reader->lengthInSamples;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(file.numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(file.numChannels));
+
+    auto& processor = workers.front()->processor;
+
+    if (!processor.checkBusesLayoutSupported(layout)) {
+        file.result.error = juce::String(file.numChannels) + " channels are not supported";
+        return;
+    }
+
+    auto* format = formatManager.findFormatForFileExtension(file.outputFile.getFileExtension());
+    file.outputFile.deleteFile();
+    auto outputStream = file.outputFile.createOutputStream();
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    if (format != nullptr && outputStream != nullptr) {
+        writer.reset(format->createWriterFor(outputStream.get(), file.sampleRate,
+                                             static_cast<unsigned int>(file.numChannels),
+                                             static_cast<int>(reader->bitsPerSample), reader->metadataValues, 0));
+    }
+
+    if (writer == nullptr) {
+        file.result.error = "can't be written";
+        return;
+    }
+
+    // The writer owns the stream from here on, and the threaded writer owns the writer
+    outputStream.release();
+    file.writer = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(writer.release(),
+                                                                            getIOThread(fileIndex),
+                                                                            options.blockSize * 8);
+
+    file.warmUpSamples = getWarmUpSamples(processor.getParameterTable().getChainSettings(), file.sampleRate);
+
+    auto chunkLength = juce::jmax(static_cast<juce::int64>(options.chunkSeconds * file.sampleRate),
+                                  static_cast<juce::int64>(options.blockSize));
+    file.numChunks = juce::jmax(1, static_cast<int>((file.lengthInSamples + chunkLength - 1) / chunkLength));
+
+    for (int chunk = 0; chunk < file.numChunks; ++chunk) {
+        auto start = chunk * chunkLength;
+        pendingJobs.push_back({&file, chunk, start, juce::jmin(chunkLength, file.lengthInSamples - start)});
+    }
+}
+
+std::optional<RenderScheduler::Job> RenderScheduler::takeJob(Worker& thief) {
+    {
+        std::lock_guard<std::mutex> lock(thief.jobLock);
+
+        if (!thief.jobs.empty()) {
+            auto job = thief.jobs.front();
+            thief.jobs.pop_front();
+            return job;
+        }
+    }
+
+    // No jobs are added once the workers run, so finding every deque empty means the run is done
+    for (size_t i = 1; i < workers.size(); ++i) {
+        auto& victim = *workers[(thief.index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.jobLock);
+
+        if (!victim.jobs.empty()) {
+            auto job = victim.jobs.back();
+            victim.jobs.pop_back();
+            return job;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void RenderScheduler::renderJob(Worker& worker, const Job& job) {
+    auto& file = *job.file;
+    auto& processor = worker.processor;
+    juce::AudioBuffer<float> chunk(file.numChannels, static_cast<int>(job.length));
+
+    std::unique_ptr<juce::AudioFormatReader> source(worker.formatManager.createReaderFor(file.inputFile));
+
+    if (source == nullptr) {
+        finishChunk(file, job.chunkIndex, std::move(chunk), "can't be reopened for reading");
+        return;
+    }
+
+    // Blocks in read() until the I/O thread has caught up instead of handing back silence
+    juce::BufferingAudioReader reader(source.release(), getIOThread(worker.index), options.blockSize * 4);
+    reader.setReadTimeout(-1);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(file.numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(file.numChannels));
+    processor.setBusesLayout(layout);
+
+    // Offline, so the processor designs coefficients inline and every chunk renders deterministically
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(file.sampleRate, options.blockSize);
+    processor.prepareToPlay(file.sampleRate, options.blockSize);
+
+    juce::MidiBuffer midiMessages;
+    auto processTicks = juce::int64 {0};
+
+    auto processRange = [&](juce::AudioBuffer<float>& buffer, juce::int64 position, int numSamples) {
+        reader.read(&buffer, 0, numSamples, position, true, true);
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midiMessages);
+        processTicks += juce::Time::getHighResolutionTicks() - start;
+    };
+
+    // In linear phase mode the output lags the input by the processor's latency, so the input is
+    // read that far ahead (past the end it reads as silence) to keep the output aligned with the
+    // source, and the warm-up covers the whole FIR kernel
+    auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+    auto warmUpSamples = juce::jmax(file.warmUpSamples, 2 * latency);
+    auto readStart = job.start + latency;
+
+    auto warmUpStart = juce::jmax(static_cast<juce::int64>(0), readStart - warmUpSamples);
+    juce::AudioBuffer<float> warmUp(file.numChannels, options.blockSize);
+
+    for (auto position = warmUpStart; position < readStart; position += options.blockSize) {
+        auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), readStart - position));
+        warmUp.setSize(file.numChannels, numSamples, false, false, true);
+        processRange(warmUp, position, numSamples);
+    }
+
+    // Processed in place inside the chunk, through buffers that refer to its channels
+    for (juce::int64 offset = 0; offset < job.length; offset += options.blockSize) {
+        auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), job.length - offset));
+        juce::AudioBuffer<float> block(chunk.getArrayOfWritePointers(), file.numChannels,
+                                       static_cast<int>(offset), numSamples);
+        processRange(block, readStart + offset, numSamples);
+    }
+
+    processor.releaseResources();
+
+    worker.numSamples += job.length * file.numChannels;
+    worker.processSeconds += juce::Time::highResolutionTicksToSeconds(processTicks);
+
+    finishChunk(file, job.chunkIndex, std::move(chunk), {});
+}
+
+void RenderScheduler::finishChunk(OutputFile& file, int chunkIndex, juce::AudioBuffer<float>&& chunk,
+                                  const juce::String& error) {
+    std::lock_guard<std::mutex> lock(file.lock);
+
+    if (error.isNotEmpty() && file.result.error.isEmpty()) {
+        file.result.error = error;
+    }
+
+    file.finishedChunks.emplace(chunkIndex, std::move(chunk));
+
+    for (auto next = file.finishedChunks.find(file.nextChunkToWrite); next != file.finishedChunks.end();
+         next = file.finishedChunks.find(file.nextChunkToWrite)) {
+        auto& buffer = next->second;
+
+        // The writer's FIFO holds eight blocks, waiting for it to drain is the backpressure on a slow disk
+        for (int offset = 0; offset < buffer.getNumSamples() && file.result.error.isEmpty(); offset += options.blockSize) {
+            auto numSamples = juce::jmin(options.blockSize, buffer.getNumSamples() - offset);
+            std::vector<const float*> channels;
+
+            for (int channel = 0; channel < file.numChannels; ++channel) {
+                channels.push_back(buffer.getReadPointer(channel, offset));
+            }
+
+            while (!file.writer->write(channels.data(), numSamples)) {
+                juce::Thread::sleep(1);
+            }
+        }
+
+        file.result.numSamples += buffer.getNumSamples() * file.numChannels;
+        file.finishedChunks.erase(next);
+        ++file.nextChunkToWrite;
+    }
+
+    if (file.nextChunkToWrite == file.numChunks) {
+        // Flushes whatever is still queued and closes the file
+        file.writer.reset();
+        file.result.latencySeconds = (juce::Time::getMillisecondCounterHiRes() - runStartMs) / 1000.0;
+
+        if (file.result.error.isNotEmpty()) {
+            file.outputFile.deleteFile();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Renders a list of files with one SimpleEQAudioProcessor per worker thread.
+// Files longer than the chunk length are split into chunks that render independently. Every chunk
+// but the first starts early and throws away a warm-up stretch long enough for the chain's slowest
+// pole to die out, so its filter state matches an uninterrupted render at the boundary.
+// Each worker takes jobs from the front of its own deque and, once that's empty, steals from the
+// back of the others'. Reads are buffered ahead and writes drained by background I/O threads, so
+// disk access overlaps with the DSP.
+class RenderScheduler {
+public:
+    struct Options {
+        int numWorkers {1};
+        int numIOThreads {1};
+        int blockSize {8192};
+        double chunkSeconds {10.0};
+    };
+
+    struct FileResult {
+        juce::File inputFile, outputFile;
+        juce::String error;  // empty if the file rendered
+        juce::int64 numSamples {0};
+        double latencySeconds {0.0};  // from the start of run() until the output was complete
+    };
+
+    struct RunResult {
+        std::vector<FileResult> files;
+        juce::int64 numSamples {0};
+        double wallSeconds {0.0};
+        double processSeconds {0.0};  // spent in processBlock, summed over all workers
+    };
+
+    // Every worker's processor is restored from processorState, a getStateInformation blob.
+    // Call from the message thread, like anything else that creates a processor.
+    RenderScheduler(const juce::MemoryBlock& processorState, const Options& options);
+    ~RenderScheduler();
+
+    void addFile(const juce::File& inputFile, const juce::File& outputFile);
+
+    // Blocks until every file has been rendered
+    RunResult run();
+
+private:
+    struct OutputFile;
+    struct Job;
+    struct Worker;
+
+    void scheduleFile(OutputFile& file, size_t fileIndex);
+    std::optional<Job> takeJob(Worker& thief);
+    void renderJob(Worker& worker, const Job& job);
+    void finishChunk(OutputFile& file, int chunkIndex, juce::AudioBuffer<float>&& chunk, const juce::String& error);
+
+    juce::TimeSliceThread& getIOThread(size_t index) { return *ioThreads[index % ioThreads.size()]; }
+
+    Options options;
+    juce::AudioFormatManager formatManager;
+    std::vector<std::unique_ptr<juce::TimeSliceThread>> ioThreads;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::unique_ptr<OutputFile>> files;
+    std::vector<Job> pendingJobs;
+    double runStartMs {0.0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderScheduler)
+};
@@ -0,0 +1,71 @@
+#include "ResponseCurve.h"
+
+bool ResponseCurve::update(const ChainCoefficients& coefficients, int newNumPoints, double newSampleRate) {
+    auto pointsChanged = newNumPoints != numPoints || !juce::approximatelyEqual(newSampleRate, sampleRate);
+
+    if (pointsChanged) {
+        numPoints = newNumPoints;
+        sampleRate = newSampleRate;
+
+        auto size = static_cast<size_t>(juce::jmax(0, numPoints));
+        std::vector<double> frequencies(size);
+        magnitudesInDecibels.resize(size);
+
+        for (size_t i = 0; i < size; ++i) {
+            frequencies[i] = juce::mapToLog10(static_cast<double>(i) / static_cast<double>(size), 20.0, 20000.0);
+        }
+
+        frequencyResponse.prepare(frequencies.data(), size, sampleRate);
+    }
+
+    auto changed = pointsChanged;
+    std::array<const CoefficientArray*, maxNumChainSections> active {};
+
+    // Flat bands are left out like SIMDBiquadCascade leaves them out
+    forEachActiveSection(coefficients, [&active](size_t slot, const CoefficientArray& section) {
+        active[slot] = &section;
+    });
+
+    for (size_t slot = 0; slot < stages.size(); ++slot) {
+        changed |= updateStage(stages[slot], active[slot], pointsChanged);
+    }
+
+    if (!changed) {
+        return false;
+    }
+
+    std::fill(magnitudesInDecibels.begin(), magnitudesInDecibels.end(), 0.0);
+
+    for (const auto& stage : stages) {
+        if (stage.active) {
+            for (size_t i = 0; i < magnitudesInDecibels.size(); ++i) {
+                magnitudesInDecibels[i] += stage.magnitudesInDecibels[i];
+            }
+        }
+    }
+
+    // Same floor as juce::Decibels::gainToDecibels
+    for (auto& magnitude : magnitudesInDecibels) {
+        magnitude = juce::jmax(magnitude, -100.0);
+    }
+
+    return true;
+}
+
+bool ResponseCurve::updateStage(Stage& stage, const CoefficientArray* coefficients, bool pointsChanged) {
+    if (coefficients == nullptr) {
+        auto wasActive = stage.active;
+        stage.active = false;
+        return wasActive;
+    }
+
+    if (stage.active && !pointsChanged && stage.coefficients == *coefficients) {
+        return false;
+    }
+
+    stage.active = true;
+    stage.coefficients = *coefficients;
+    stage.magnitudesInDecibels.resize(frequencyResponse.getNumFrequencies());
+    frequencyResponse.process(&stage.coefficients, 1, stage.magnitudesInDecibels.data());
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "FrequencyResponse.h"
+
+// The chain's magnitude response in dB at points spaced logarithmically from 20 Hz to 20 kHz,
+// as drawn by ResponseCurveComponent.
+// Each stage's curve is kept separately and the total is their sum, so an update only evaluates
+// the stages whose coefficients changed, through a FrequencyResponse prepared once per number of
+// points and sample rate.
+class ResponseCurve {
+public:
+    // Returns false, without touching anything, if the curve is already up to date
+    bool update(const ChainCoefficients& coefficients, int numPoints, double sampleRate);
+
+    const std::vector<double>& getMagnitudesInDecibels() const { return magnitudesInDecibels; }
+
+private:
+    struct Stage {
+        CoefficientArray coefficients {};
+        bool active {false};
+        std::vector<double> magnitudesInDecibels;
+    };
+
+    // coefficients is null for a stage that isn't active
+    bool updateStage(Stage& stage, const CoefficientArray* coefficients, bool pointsChanged);
+
+    int numPoints {0};
+    double sampleRate {0.0};
+
+    FrequencyResponse frequencyResponse;
+
+    // One per chain section slot, see forEachActiveSection
+    std::array<Stage, maxNumChainSections> stages;
+    std::vector<double> magnitudesInDecibels;
+};
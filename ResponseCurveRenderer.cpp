@@ -0,0 +1,111 @@
+#include "ResponseCurveRenderer.h"
+#include "ParameterTable.h"
+
+ResponseCurveRenderer::ResponseCurveRenderer(SimpleEQAudioProcessor& p)
+    : juce::Thread("SimpleEQ Response Curve"), processor(p) {
+    processor.setAnalyzerEnabled(true);
+    startThread(juce::Thread::Priority::low);
+}
+
+ResponseCurveRenderer::~ResponseCurveRenderer() {
+    processor.setAnalyzerEnabled(false);
+    stopThread(1000);
+}
+
+bool ResponseCurveRenderer::hasNewAudio() const {
+    return processor.getPostEqFifo().getNumReady() > 0;
+}
+
+void ResponseCurveRenderer::requestFrame(int width, int height, float scale, double sampleRate) {
+    requests.getWriteBuffer() = {width, height, scale, sampleRate};
+    requests.publish();
+    notify();
+}
+
+void ResponseCurveRenderer::run() {
+    while (!threadShouldExit()) {
+        if (auto* request = requests.pull()) {
+            render(*request);
+        }
+
+        wait(-1);
+    }
+}
+
+void ResponseCurveRenderer::render(const Request& request) {
+    auto width = juce::roundToInt(static_cast<float>(request.width) * request.scale);
+    auto height = juce::roundToInt(static_cast<float>(request.height) * request.scale);
+
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // At the rate the cascade runs at, so oversampling's effect on the curve shows
+    const auto& parameters = processor.getParameterTable();
+    auto generation = parameters.getGeneration();
+    auto processingRate = parameters.getProcessingSampleRate(request.sampleRate);
+
+    // Frames drawn for new audio alone don't need the settings read again
+    if (generation != chainGeneration || !juce::approximatelyEqual(processingRate, chainCoefficients.sampleRate)) {
+        updateChainCoefficients(chainCoefficients, parameters.getChainSettings(), processingRate);
+        chainGeneration = generation;
+    }
+
+    // One point per physical pixel
+    auto curveChanged = responseCurve.update(chainCoefficients, width, processingRate);
+    auto sizeChanged = request.width != lastRendered.width || request.height != lastRendered.height
+                    || !juce::approximatelyEqual(request.scale, lastRendered.scale);
+
+    // Both always, so neither fifo is left to fill up
+    auto preEqAnalysed = preEqAnalyzer.process(processor.getPreEqFifo(), request.sampleRate);
+    auto postEqAnalysed = postEqAnalyzer.process(processor.getPostEqFifo(), request.sampleRate);
+
+    if (!curveChanged && !sizeChanged && !preEqAnalysed && !postEqAnalysed) {
+        return;
+    }
+
+    lastRendered = request;
+
+    const auto& mags = responseCurve.getMagnitudesInDecibels();
+    const double outputMin = height;
+    const double outputMax = 0.0;
+    auto map = [outputMin, outputMax](double input) {
+        return static_cast<float>(juce::jmap(input, -24.0, 24.0, outputMin, outputMax));
+    };
+
+    responseCurvePath.clear();
+    responseCurvePath.preallocateSpace(3 * width);
+    responseCurvePath.startNewSubPath(0.f, map(mags.front()));
+
+    for (size_t i = 1; i < mags.size(); ++i) {
+        responseCurvePath.lineTo(static_cast<float>(i), map(mags[i]));
+    }
+
+    preEqAnalyzer.createPath(preEqSpectrumPath, width, height, request.sampleRate);
+    postEqAnalyzer.createPath(postEqSpectrumPath, width, height, request.sampleRate);
+
+    // The slot published two frames ago - reused as long as the size holds. Software images,
+    // since they're drawn off the message thread.
+    auto& frame = frames.getWriteBuffer();
+
+    if (frame.isNull() || frame.getWidth() != width || frame.getHeight() != height) {
+        frame = juce::Image(juce::Image::RGB, width, height, false, juce::SoftwareImageType());
+    }
+
+    {
+        juce::Graphics g(frame);
+        g.fillAll(juce::Colours::black);
+
+        g.setColour(juce::Colours::dimgrey);
+        g.strokePath(preEqSpectrumPath, juce::PathStrokeType(request.scale));
+        g.setColour(juce::Colours::skyblue);
+        g.strokePath(postEqSpectrumPath, juce::PathStrokeType(request.scale));
+
+        g.setColour(juce::Colours::orange);
+        g.drawRoundedRectangle(frame.getBounds().toFloat(), 4.f * request.scale, request.scale);
+        g.setColour(juce::Colours::white);
+        g.strokePath(responseCurvePath, juce::PathStrokeType(2.f * request.scale));
+    }
+
+    frames.publish();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ResponseCurve.h"
+#include "SpectrumAnalyzer.h"
+#include "TripleBuffer.h"
+
+// Draws the response curve, over the pre- and post-EQ spectra, into an image on its own thread,
+// so the message thread never runs an FFT or builds or strokes a path. The processor feeds the
+// analyzers only while a renderer exists. Frame requests go in through one TripleBuffer and finished images come
+// back through another: the component only publishes what it wants drawn and blits whatever
+// was finished last.
+class ResponseCurveRenderer final : private juce::Thread {
+public:
+    explicit ResponseCurveRenderer(SimpleEQAudioProcessor& processor);
+    ~ResponseCurveRenderer() override;
+
+    // Message thread - draws the current settings at width x height points, scale being the
+    // number of physical pixels per point. Requests that come in faster than frames are drawn
+    // replace each other.
+    void requestFrame(int width, int height, float scale, double sampleRate);
+
+    // Message thread - the newest finished frame, or nullptr if none was finished since the last pull
+    const juce::Image* pull() { return frames.pull(); }
+
+    // Message thread - the frame returned by the last pull, null until one was pulled
+    const juce::Image& getFrame() const { return frames.getReadBuffer(); }
+
+    // Whether the processor pushed audio that the next frame would analyse
+    bool hasNewAudio() const;
+
+private:
+    struct Request {
+        int width {0}, height {0};
+        float scale {1.f};
+        double sampleRate {0.0};
+    };
+
+    void run() override;
+    void render(const Request& request);
+
+    SimpleEQAudioProcessor& processor;
+    TripleBuffer<Request> requests;
+    TripleBuffer<juce::Image> frames;
+
+    // Only touched by the render thread
+    ChainCoefficients chainCoefficients;
+    // The parameters' generation chainCoefficients was last brought up to date at
+    juce::uint32 chainGeneration {0};
+    ResponseCurve responseCurve;
+    juce::Path responseCurvePath;
+    SpectrumAnalyzer preEqAnalyzer, postEqAnalyzer;
+    juce::Path preEqSpectrumPath, postEqSpectrumPath;
+    Request lastRendered;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurveRenderer)
+};
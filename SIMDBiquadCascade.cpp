@@ -0,0 +1,343 @@
+#include "SIMDBiquadCascade.h"
+
+template<typename SampleType>
+using Engine = SIMDBiquadCascade::Engine<SampleType>;
+
+template<typename SampleType>
+using Register = typename Engine<SampleType>::Register;
+
+void SIMDBiquadCascade::prepare(const juce::dsp::ProcessSpec& spec) {
+    numChannels = static_cast<size_t>(spec.numChannels);
+
+    singlePrecision.prepare((numChannels + Engine<float>::numLanes - 1) / Engine<float>::numLanes);
+    doublePrecision.prepare((numChannels + Engine<double>::numLanes - 1) / Engine<double>::numLanes);
+
+    reset();
+}
+
+template<typename SampleType>
+void SIMDBiquadCascade::Engine<SampleType>::prepare(size_t newNumGroups) {
+    numGroups = newNumGroups;
+    s1.resize(numGroups * maxNumSections);
+    s2.resize(numGroups * maxNumSections);
+}
+
+void SIMDBiquadCascade::reset() {
+    for (size_t section = 0; section < maxNumSections; ++section) {
+        resetSection(section);
+    }
+}
+
+void SIMDBiquadCascade::resetSection(size_t section) {
+    singlePrecision.resetSection(section);
+    doublePrecision.resetSection(section);
+}
+
+template<typename SampleType>
+void SIMDBiquadCascade::Engine<SampleType>::resetSection(size_t section) {
+    for (size_t group = 0; group < numGroups; ++group) {
+        s1[group * maxNumSections + section] = Register::expand(0);
+        s2[group * maxNumSections + section] = Register::expand(0);
+    }
+}
+
+// Transposed direct form II, same as IIR::Filter, over one register of channels
+template<size_t Index, typename SampleType>
+static inline Register<SampleType> processSection(const typename Engine<SampleType>::BiquadSections& sections,
+                                                  Register<SampleType>& s1, Register<SampleType>& s2,
+                                                  Register<SampleType> input) noexcept {
+    auto output = sections.b0[Index] * input + s1;
+
+    s1 = sections.b1[Index] * input - sections.a1[Index] * output + s2;
+    s2 = sections.b2[Index] * input - sections.a2[Index] * output;
+
+    return output;
+}
+
+// The trapezoidal state variable filter, with s1 and s2 the band and low pass integrators' states
+template<size_t Index, typename SampleType>
+static inline Register<SampleType> processSection(const typename Engine<SampleType>::StateVariableSections& sections,
+                                                  Register<SampleType>& s1, Register<SampleType>& s2,
+                                                  Register<SampleType> input) noexcept {
+    auto v3 = input - s2;
+    auto bandPass = sections.a1[Index] * s1 + sections.a2[Index] * v3;
+    auto lowPass = s2 + sections.a2[Index] * s1 + sections.a3[Index] * v3;
+
+    s1 = bandPass + bandPass - s1;
+    s2 = lowPass + lowPass - s2;
+
+    return sections.m0[Index] * input + sections.m1[Index] * bandPass + sections.m2[Index] * lowPass;
+}
+
+template<typename SampleType, typename Sections, size_t... Indices>
+static void processTile(const Sections& sections, Register<SampleType>* s1, Register<SampleType>* s2,
+                        SampleType* tile, size_t numSamples, std::index_sequence<Indices...>) noexcept {
+    // Local copies so the compiler can keep the whole cascade's state in registers
+    std::array<Register<SampleType>, sizeof...(Indices)> localS1 {s1[Indices]...};
+    std::array<Register<SampleType>, sizeof...(Indices)> localS2 {s2[Indices]...};
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        auto* frame = tile + i * Engine<SampleType>::numLanes;
+        auto sample = Register<SampleType>::fromRawArray(frame);
+
+        ((sample = processSection<Indices, SampleType>(sections, localS1[Indices], localS2[Indices], sample)), ...);
+
+        sample.copyToRawArray(frame);
+    }
+
+    ((s1[Indices] = localS1[Indices], s2[Indices] = localS2[Indices]), ...);
+}
+
+template<typename SampleType, typename Sections, size_t NumSections>
+static void processTile(const Sections& sections, Register<SampleType>* s1, Register<SampleType>* s2,
+                        SampleType* tile, size_t numSamples) noexcept {
+    processTile<SampleType>(sections, s1, s2, tile, numSamples, std::make_index_sequence<NumSections>());
+}
+
+template<typename SampleType, typename Sections, size_t... Indices>
+static auto makeTileKernels(std::index_sequence<Indices...>) {
+    using TileKernel = typename Engine<SampleType>::template TileKernel<Sections>;
+    return std::array<TileKernel, sizeof...(Indices)> {&processTile<SampleType, Sections, Indices + 1>...};
+}
+
+// tileKernels[n - 1] processes n sections, for every possible number of active sections
+template<typename SampleType, typename Sections>
+static const auto tileKernels = makeTileKernels<SampleType, Sections>(std::make_index_sequence<SIMDBiquadCascade::maxNumSections>());
+
+template<typename SampleType>
+static void setBiquadSection(typename Engine<SampleType>::BiquadSections& sections, size_t index,
+                             const CoefficientArray& coefficients) {
+    auto expand = [](double coefficient) { return Register<SampleType>::expand(static_cast<SampleType>(coefficient)); };
+
+    sections.b0[index] = expand(coefficients[0]);
+    sections.b1[index] = expand(coefficients[1]);
+    sections.b2[index] = expand(coefficients[2]);
+    sections.a1[index] = expand(coefficients[4]);
+    sections.a2[index] = expand(coefficients[5]);
+}
+
+// Any stable biquad is a state variable filter with some g, k and output mix: its denominator is
+// (1 + g (g + k)) + 2 (g^2 - 1) z^-1 + (1 + g (g - k)) z^-2, and its numerator a mix of the high pass
+// (1 - z^-1)^2, band pass g (1 - z^-2) and low pass g^2 (1 + z^-1)^2 outputs. Solved in double
+// precision, so g and k stay exact even where a1 and a2 hardly differ from -2 and 1.
+template<typename SampleType>
+static void setStateVariableSection(typename Engine<SampleType>::StateVariableSections& sections, size_t index,
+                                    const CoefficientArray& coefficients) {
+    auto b0 = coefficients[0], b1 = coefficients[1], b2 = coefficients[2];
+    auto a1 = coefficients[4], a2 = coefficients[5];
+
+    // The denominator at DC and at Nyquist, 4 g^2 / d and 4 / d with d = 1 + g (g + k)
+    auto atDc = juce::jmax(1.0 + a1 + a2, std::numeric_limits<double>::min());
+    auto atNyquist = 1.0 - a1 + a2;
+
+    auto g = std::sqrt(atDc / atNyquist);
+    auto k = 2.0 * (1.0 - a2) / (atNyquist * g);
+    auto d = 1.0 + g * (g + k);
+
+    auto highPass = d * (b0 - b1 + b2) / 4.0;
+    auto bandPass = d * (b0 - b2) / (2.0 * g);
+    auto lowPass = d * (b0 + b1 + b2) / (4.0 * g * g);
+
+    auto expand = [](double coefficient) { return Register<SampleType>::expand(static_cast<SampleType>(coefficient)); };
+
+    sections.a1[index] = expand(1.0 / d);
+    sections.a2[index] = expand(g / d);
+    sections.a3[index] = expand(g * g / d);
+
+    // The high pass output is input - k band pass - low pass, so it's folded into the other two
+    sections.m0[index] = expand(highPass);
+    sections.m1[index] = expand(bandPass - k * highPass);
+    sections.m2[index] = expand(lowPass - highPass);
+}
+
+template<typename SampleType>
+void SIMDBiquadCascade::Engine<SampleType>::setSections(const CoefficientArray* coefficients, size_t numSections,
+                                                         FilterTopology topology) {
+    for (size_t i = 0; i < numSections; ++i) {
+        if (topology == FilterTopology_StateVariable) {
+            setStateVariableSection<SampleType>(stateVariableSections, i, coefficients[i]);
+        }
+        else {
+            setBiquadSection<SampleType>(biquadSections, i, coefficients[i]);
+        }
+    }
+
+    biquadKernel = numSections > 0 ? tileKernels<SampleType, BiquadSections>[numSections - 1] : nullptr;
+    stateVariableKernel = numSections > 0 ? tileKernels<SampleType, StateVariableSections>[numSections - 1] : nullptr;
+}
+
+void SIMDBiquadCascade::setTopology(FilterTopology newTopology) {
+    if (newTopology == topology) {
+        return;
+    }
+
+    topology = newTopology;
+    updateEngines();
+    reset();
+}
+
+void SIMDBiquadCascade::setCoefficients(const ChainCoefficients& coefficients) {
+    std::array<bool, maxNumSections> active {};
+    std::array<CoefficientArray, maxNumSections> sections {};
+
+    // Bands that pass the signal through untouched - bypassed ones, or a bell at 0 dB - aren't processed
+    forEachActiveSection(coefficients, [&active, &sections](size_t slot, const CoefficientArray& section) {
+        sections[slot] = section;
+        active[slot] = true;
+    });
+
+    numActiveSections = 0;
+
+    for (size_t section = 0; section < maxNumSections; ++section) {
+        if (!active[section]) {
+            continue;
+        }
+
+        // A section coming back from bypass shouldn't ring out whatever it held when it was switched off
+        if (!sectionIsActive[section]) {
+            resetSection(section);
+        }
+
+        // CoefficientArray is b0, b1, b2, a0, a1, a2 - normalise so that a0 == 1
+        auto& normalised = activeCoefficients[numActiveSections];
+        auto a0Inverse = 1.0 / sections[section][3];
+
+        for (size_t i = 0; i < normalised.size(); ++i) {
+            normalised[i] = sections[section][i] * a0Inverse;
+        }
+
+        activeSections[numActiveSections++] = section;
+    }
+
+    sectionIsActive = active;
+    updateEngines();
+}
+
+void SIMDBiquadCascade::updateEngines() {
+    singlePrecision.setSections(activeCoefficients.data(), numActiveSections, topology);
+    doublePrecision.setSections(activeCoefficients.data(), numActiveSections, topology);
+}
+
+void SIMDBiquadCascade::process(const juce::dsp::AudioBlock<float>& block) noexcept {
+    process(singlePrecision, block);
+}
+
+void SIMDBiquadCascade::process(const juce::dsp::AudioBlock<double>& block) noexcept {
+    process(doublePrecision, block);
+}
+
+bool SIMDBiquadCascade::isSilent(float threshold) const noexcept {
+    return isSilent(singlePrecision, threshold);
+}
+
+bool SIMDBiquadCascade::isSilent(double threshold) const noexcept {
+    return isSilent(doublePrecision, threshold);
+}
+
+template<typename SampleType>
+bool SIMDBiquadCascade::isSilent(const Engine<SampleType>& engine, SampleType threshold) const noexcept {
+    constexpr auto numLanes = Engine<SampleType>::numLanes;
+    alignas(Register<SampleType>) SampleType lanes[numLanes];
+
+    auto exceeds = [&lanes, threshold](const Register<SampleType>& value) {
+        value.copyToRawArray(lanes);
+        return std::any_of(lanes, lanes + numLanes, [threshold](SampleType x) { return std::abs(x) > threshold; });
+    };
+
+    for (size_t group = 0; group < engine.numGroups; ++group) {
+        for (size_t i = 0; i < numActiveSections; ++i) {
+            auto index = group * maxNumSections + activeSections[i];
+
+            if (exceeds(engine.s1[index]) || exceeds(engine.s2[index])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<typename SampleType>
+static void interleave(SampleType* tile, const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel,
+                       size_t numChannelsInGroup, size_t start, size_t numSamples) noexcept {
+    constexpr auto numLanes = Engine<SampleType>::numLanes;
+
+    for (size_t lane = 0; lane < numLanes; ++lane) {
+        // Unused lanes are kept silent rather than left holding garbage
+        if (lane >= numChannelsInGroup) {
+            for (size_t i = 0; i < numSamples; ++i) {
+                tile[i * numLanes + lane] = 0;
+            }
+
+            continue;
+        }
+
+        const auto* channel = block.getChannelPointer(firstChannel + lane) + start;
+
+        for (size_t i = 0; i < numSamples; ++i) {
+            tile[i * numLanes + lane] = channel[i];
+        }
+    }
+}
+
+template<typename SampleType>
+static void deinterleave(const SampleType* tile, const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel,
+                         size_t numChannelsInGroup, size_t start, size_t numSamples) noexcept {
+    constexpr auto numLanes = Engine<SampleType>::numLanes;
+
+    for (size_t lane = 0; lane < numChannelsInGroup; ++lane) {
+        auto* channel = block.getChannelPointer(firstChannel + lane) + start;
+
+        for (size_t i = 0; i < numSamples; ++i) {
+            channel[i] = tile[i * numLanes + lane];
+        }
+    }
+}
+
+template<typename SampleType>
+void SIMDBiquadCascade::process(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block) noexcept {
+    if (numActiveSections == 0) {
+        return;
+    }
+
+    constexpr auto numLanes = Engine<SampleType>::numLanes;
+    auto numSamples = block.getNumSamples();
+    auto channelsToProcess = juce::jmin(block.getNumChannels(), numChannels);
+
+    for (size_t group = 0; group * numLanes < channelsToProcess; ++group) {
+        auto firstChannel = group * numLanes;
+        auto numChannelsInGroup = juce::jmin(numLanes, channelsToProcess - firstChannel);
+        auto* groupS1 = engine.s1.data() + group * maxNumSections;
+        auto* groupS2 = engine.s2.data() + group * maxNumSections;
+
+        // Gathered in the same order as the engine's compacted sections for the kernel
+        std::array<Register<SampleType>, maxNumSections> activeS1, activeS2;
+
+        for (size_t i = 0; i < numActiveSections; ++i) {
+            activeS1[i] = groupS1[activeSections[i]];
+            activeS2[i] = groupS2[activeSections[i]];
+        }
+
+        for (size_t start = 0; start < numSamples; start += tileSize) {
+            auto numTileSamples = juce::jmin(tileSize, numSamples - start);
+
+            interleave(engine.tile, block, firstChannel, numChannelsInGroup, start, numTileSamples);
+
+            if (topology == FilterTopology_StateVariable) {
+                engine.stateVariableKernel(engine.stateVariableSections, activeS1.data(), activeS2.data(),
+                                           engine.tile, numTileSamples);
+            }
+            else {
+                engine.biquadKernel(engine.biquadSections, activeS1.data(), activeS2.data(),
+                                    engine.tile, numTileSamples);
+            }
+
+            deinterleave(engine.tile, block, firstChannel, numChannelsInGroup, start, numTileSamples);
+        }
+
+        for (size_t i = 0; i < numActiveSections; ++i) {
+            groupS1[activeSections[i]] = activeS1[i];
+            groupS2[activeSections[i]] = activeS2[i];
+        }
+    }
+}
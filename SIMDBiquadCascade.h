@@ -0,0 +1,106 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+
+// Runs the LowCut -> Peaks -> HighCut biquads over several channels at once. Every channel shares
+// the same coefficients, so the channels are interleaved into the lanes of a SIMDRegister and each
+// section runs once for a whole group of channels instead of once per channel.
+// The block is walked once, a small tile at a time, and each sample of the tile goes through every
+// active section before the next one. Active sections are compacted to the front of flat,
+// per-coefficient arrays, and the loop over them is instantiated for each possible number of active
+// sections and picked when the coefficients change - so it is fully unrolled with all the state in
+// registers, never checks for bypassed sections, and costs the same however many bands are unused.
+// Float blocks are processed in single precision and double blocks in double precision. Either
+// way, each section runs as a transposed direct form II biquad, like IIR::Filter, or as the
+// equivalent topology-preserving transform state variable filter.
+class SIMDBiquadCascade {
+public:
+    // One slot per section, see forEachActiveSection()
+    static constexpr size_t maxNumSections = maxNumChainSections;
+
+    // Samples per tile - small enough for the interleaved tile to stay in L1
+    static constexpr size_t tileSize = 64;
+
+    // Everything that depends on the precision the sections run in
+    template<typename SampleType>
+    struct Engine {
+        using Register = juce::dsp::SIMDRegister<SampleType>;
+        static constexpr size_t numLanes = Register::SIMDNumElements;
+
+        using Registers = std::array<Register, maxNumSections>;
+
+        // Normalised biquad coefficients of the active sections, broadcast to every lane
+        struct BiquadSections {
+            Registers b0, b1, b2, a1, a2;
+        };
+
+        // A. Simper's trapezoidal SVF: a1, a2 and a3 come from g = tan(w / 2) and the damping k,
+        // and m0, m1 and m2 mix the input, band pass and low pass outputs into the section's output
+        struct StateVariableSections {
+            Registers a1, a2, a3, m0, m1, m2;
+        };
+
+        // Processes a tile through a fixed number of sections, see makeTileKernels(). s1 and s2 are
+        // z^-1 and z^-2 for a biquad, the two integrators' states for a state variable filter.
+        template<typename Sections>
+        using TileKernel = void (*)(const Sections& sections, Register* s1, Register* s2,
+                                    SampleType* tile, size_t numSamples) noexcept;
+
+        void prepare(size_t numGroups);
+        void resetSection(size_t section);
+        // Rebuilds the active sections for topology from their coefficients, packed in chain order
+        void setSections(const CoefficientArray* coefficients, size_t numSections, FilterTopology topology);
+
+        BiquadSections biquadSections {};
+        StateVariableSections stateVariableSections {};
+        TileKernel<BiquadSections> biquadKernel {nullptr};
+        TileKernel<StateVariableSections> stateVariableKernel {nullptr};
+
+        size_t numGroups {0};
+        // maxNumSections of each state per group of numLanes channels, by slot
+        std::vector<Register> s1, s2;
+
+        // One register's worth of lanes per sample of the tile
+        alignas(Register) SampleType tile[tileSize * numLanes] {};
+    };
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // Neither topology's state means anything to the other, so switching starts from silence
+    void setTopology(FilterTopology newTopology);
+    FilterTopology getTopology() const { return topology; }
+
+    void setCoefficients(const ChainCoefficients& coefficients);
+
+    // Processes min(block channels, prepared channels) channels in place
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+    void process(const juce::dsp::AudioBlock<double>& block) noexcept;
+
+    // True once every active section's state, in the precision blocks of that type run in, has
+    // decayed below threshold, so that processing silence would only produce more silence
+    bool isSilent(float threshold) const noexcept;
+    bool isSilent(double threshold) const noexcept;
+
+private:
+    template<typename SampleType>
+    void process(Engine<SampleType>& engine, const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+    template<typename SampleType>
+    bool isSilent(const Engine<SampleType>& engine, SampleType threshold) const noexcept;
+    void resetSection(size_t section);
+    void updateEngines();
+
+    FilterTopology topology {FilterTopology_Biquad};
+
+    std::array<bool, maxNumSections> sectionIsActive {};
+    // Slots of the active sections, so processing never looks at bypassed ones
+    std::array<size_t, maxNumSections> activeSections {};
+    size_t numActiveSections {0};
+    // The active sections' coefficients packed in chain order, normalised so that a0 == 1
+    std::array<CoefficientArray, maxNumSections> activeCoefficients {};
+
+    size_t numChannels {0};
+
+    Engine<float> singlePrecision;
+    Engine<double> doublePrecision;
+};
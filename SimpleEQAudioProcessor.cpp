@@ -1,5 +1,13 @@
 #include "SimpleEQAudioProcessor.h"
 #include "SimpleEQAudioProcessorEditor.h"
+#include "ParameterTable.h"
+#include "PresetBank.h"
+#include "CoefficientDesigner.h"
+#include "ChainSmoother.h"
+#include "SIMDBiquadCascade.h"
+#include "RealtimeChecks.h"
+#include "SpectrumAnalyzer.h"
+#include "LinearPhaseEQ.h"
 
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
@@ -10,8 +18,17 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+       parameterTable(std::make_unique<ParameterTable>(apvts)),
+       presetBank(std::make_unique<PresetBank>(*this, *parameterTable)),
+       coefficientDesigner(std::make_unique<CoefficientDesigner>(*parameterTable)),
+       chainSmoother(std::make_unique<ChainSmoother>()),
+       cascade(std::make_unique<SIMDBiquadCascade>()),
+       linearPhaseEQ(std::make_unique<LinearPhaseEQ>()),
+       preEqFifo(std::make_unique<SampleFifo>()),
+       postEqFifo(std::make_unique<SampleFifo>())
 {
+    startTimer(latencyPollIntervalMs);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor() {
@@ -47,32 +64,83 @@ bool SimpleEQAudioProcessor::isMidiEffect() const {
 }
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const {
-    return 0.0;
+    if (getSampleRate() <= 0.0) {
+        return 0.0;
+    }
+
+    // Whatever is still in the engine's delay line comes out after the filters' own tail.
+    // Called from the message thread, so the phase mode comes from the parameter
+    if (parameterTable->isLinearPhase()) {
+        return linearPhaseEQ->getTailSamples() / getSampleRate();
+    }
+
+    return chainTailSeconds.load() + selectedLatencySamples.load() / getSampleRate();
+}
+
+juce::AudioProcessorParameter* SimpleEQAudioProcessor::getBypassParameter() const {
+    return apvts.getParameter("Bypass");
 }
 
 int SimpleEQAudioProcessor::getNumPrograms() {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-    // so this should be at least 1, even if you're not really implementing programs.
+    return numPrograms;
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram() {
-    return 0;
+    return currentProgram;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram(int index) {
-    juce::ignoreUnused(index);
+    if (!juce::isPositiveAndBelow(index, numPrograms)) {
+        return;
+    }
+
+    currentProgram = index;
+
+    // A program stored or loaded since it was last designed is designed now, before the audio
+    // thread looks for its coefficients
+    presetBank->designIfChanged(index);
+
+    // The designer catches up once every parameter is in, but the audio thread doesn't wait for
+    // it - it already has the program's coefficients
+    const CoefficientDesigner::ScopedBulkChange bulkChange(*coefficientDesigner);
+    const auto& values = presetBank->getValues(index);
+
+    setParameterValues(static_cast<int>(values.size()), [this, &values](int i, juce::RangedAudioParameter& parameter) {
+        return presetBank->isRecalled(i) ? values[static_cast<size_t>(i)] : parameter.convertFrom0to1(parameter.getValue());
+    });
+
+    pendingProgram = index;
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName(int index) {
-    juce::ignoreUnused(index);
-    return {};
+    return juce::isPositiveAndBelow(index, numPrograms) ? presetBank->getName(index) : juce::String();
 }
 
 void SimpleEQAudioProcessor::changeProgramName(int index, const juce::String& newName) {
-    juce::ignoreUnused(index, newName);
+    if (juce::isPositiveAndBelow(index, numPrograms)) {
+        presetBank->setName(index, newName);
+    }
+}
+
+void SimpleEQAudioProcessor::storeProgram(int index) {
+    if (juce::isPositiveAndBelow(index, numPrograms)) {
+        presetBank->setValues(index, getParameterValues());
+    }
 }
 
 //==============================================================================
+template<typename SampleType>
+static void prepareOversamplers(std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 3>& oversamplers,
+                                const juce::dsp::ProcessSpec& spec) {
+    for (size_t factorLog2 = 1; factorLog2 < oversamplers.size(); ++factorLog2) {
+        // Polyphase IIR half-band stages - far less latency than FIR ones, and the cascade they
+        // surround isn't linear phase anyway
+        oversamplers[factorLog2] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+                spec.numChannels, factorLog2, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true, true);
+        oversamplers[factorLog2]->initProcessing(spec.maximumBlockSize);
+    }
+}
+
 void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
@@ -80,17 +148,91 @@ void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = static_cast<unsigned int>(samplesPerBlock);
-    spec.numChannels = 1;
+    spec.numChannels = static_cast<juce::uint32>(juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
     spec.sampleRate = sampleRate;
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    cascade->prepare(spec);
+    cascade->setTopology(parameterTable->getTopology());
 
-    updateFilters();
+    if (isUsingDoublePrecision()) {
+        prepareOversamplers(doubleOversamplers, spec);
+        oversamplers = {};
+    }
+    else {
+        prepareOversamplers(oversamplers, spec);
+        doubleOversamplers = {};
+    }
+
+    oversamplingBlockSize = spec.maximumBlockSize;
+    oversamplingFactorLog2 = 0;
+    processingRate = sampleRate;
+
+    presetBank->prepare(sampleRate);
+    pendingProgram = -1;
+    programSettings.reset();
+
+    coefficientDesigner->prepare(sampleRate);
+
+    linearPhase = parameterTable->isLinearPhase();
+    linearPhaseEQ->setActive(linearPhase);
+
+    if (auto* designed = coefficientDesigner->pull()) {
+        updateOversampling(designed->sampleRate);
+        cascade->setCoefficients(*designed);
+        chainSmoother->setCurrentAndTargetValue(designed->chainSettings);
+
+        linearPhaseEQ->prepare(spec, *designed);
+        linearPhaseSettings = designed->chainSettings;
+        chainTailSeconds = getChainTailSeconds(*designed);
+    }
+
+    silentSamples = 0;
+    idle = false;
+
+    smoothingTime = parameterTable->getSmoothingTime();
+    chainSmoother->reset(processingRate, smoothingTime / 1000.0);
+
+    // Straight away rather than from the timer, hosts ask for it as soon as this returns
+    selectedLatencySamples = getSelectedLatencySamples();
+    setLatencySamples(selectedLatencySamples);
+
+    phaseModeMix.reset(sampleRate, phaseModeCrossfadeSeconds);
+    phaseModeMix.setCurrentAndTargetValue(linearPhase ? 1.f : 0.f);
+    linearPhaseBuffer.setSize(static_cast<int>(spec.numChannels), samplesPerBlock);
+
+    // Room for the longest latency of any engine, with a segment pushed in ahead of it
+    auto maxLatencySamples = linearPhaseEQ->getLatencySamples();
+    auto includeLatencies = [&maxLatencySamples](const auto& prepared) {
+        for (const auto& oversampler : prepared) {
+            if (oversampler != nullptr) {
+                maxLatencySamples = juce::jmax(maxLatencySamples, juce::roundToInt(oversampler->getLatencyInSamples()));
+            }
+        }
+    };
+
+    includeLatencies(oversamplers);
+    includeLatencies(doubleOversamplers);
+
+    auto prepareBypassDelay = [&spec, maxLatencySamples](auto& delay) {
+        delay.setMaximumDelayInSamples(maxLatencySamples + static_cast<int>(automationSubBlockSize));
+        delay.prepare(spec);
+    };
+
+    if (isUsingDoublePrecision()) {
+        prepareBypassDelay(doubleBypassDelay);
+    }
+    else {
+        prepareBypassDelay(bypassDelay);
+    }
+
+    bypassDelayMix.reset(sampleRate, bypassDelayCrossfadeSeconds);
+    bypassDelayMix.setCurrentAndTargetValue(0.f);
 }
 
 void SimpleEQAudioProcessor::releaseResources() {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner->release();
+    linearPhaseEQ->release();
 }
 
 bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
@@ -98,12 +240,10 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
 #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel goes through the same cascade, in SIMD groups sized in prepareToPlay, so any
+    // layout works - mono, stereo, surround and immersive beds, ambisonics or discrete channels -
+    // as long as there's at least one channel.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -116,9 +256,61 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 #endif
 }
 
+bool SimpleEQAudioProcessor::supportsDoublePrecisionProcessing() const {
+    return true;
+}
+
 void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                           juce::MidiBuffer& midiMessages) {
     juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                          juce::MidiBuffer& midiMessages) {
+    juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+// AudioBlock::copyFrom() only copies between blocks of the same type
+template<typename DestinationType, typename SourceType>
+static void copyConverting(const juce::dsp::AudioBlock<DestinationType>& destination,
+                           const juce::dsp::AudioBlock<SourceType>& source) {
+    if constexpr (std::is_same_v<DestinationType, SourceType>) {
+        destination.copyFrom(source);
+    }
+    else {
+        auto numChannels = juce::jmin(destination.getNumChannels(), source.getNumChannels());
+        auto numSamples = juce::jmin(destination.getNumSamples(), source.getNumSamples());
+
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            std::transform(source.getChannelPointer(channel), source.getChannelPointer(channel) + numSamples,
+                           destination.getChannelPointer(channel),
+                           [](SourceType sample) { return static_cast<DestinationType>(sample); });
+        }
+    }
+}
+
+// Whether every sample of block lies within +-threshold
+template<typename SampleType>
+static bool isSilent(const juce::dsp::AudioBlock<SampleType>& block, SampleType threshold) {
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+        auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(channel),
+                                                                static_cast<int>(block.getNumSamples()));
+
+        if (range.getStart() < -threshold || range.getEnd() > threshold) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer) {
+    // Records anything below that allocates or locks, in builds with SIMPLEEQ_REALTIME_CHECKS.
+    // Offline renders have no deadline to miss, so they're left alone
+    ScopedRealtimeGuard realtimeGuard(!isNonRealtime());
 
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
@@ -134,18 +326,455 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
         buffer.clear(i, 0, buffer.getNumSamples());
 }
 
+    updatePhaseMode();
     updateFilters();
+    updateBypassRoute();
+
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    auto analyzerBlock = block.getSubsetChannelBlock(0, static_cast<size_t>(totalNumInputChannels));
+    auto feedAnalyzer = analyzerEnabled.load(std::memory_order_relaxed);
+
+    if (feedAnalyzer) {
+        preEqFifo->push(analyzerBlock);
+    }
+
+    auto inputIsSilent = isSilent(analyzerBlock, static_cast<SampleType>(silenceThreshold));
+
+    if (inputIsSilent) {
+        silentSamples += buffer.getNumSamples();
+    }
+    else {
+        silentSamples = 0;
+        idle = false;
+    }
+
+    if (idle) {
+        block.clear();
+    }
+    else {
+        processSegmented(block);
+
+        if (inputIsSilent && hasDecayed(block)) {
+            // What's left is below the threshold - cleared, so the input coming back starts from silence
+            idle = true;
+            resetEngines();
+            getBypassDelay<SampleType>().reset();
+        }
+    }
+
+    if (feedAnalyzer) {
+        postEqFifo->push(analyzerBlock);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSegmented(const juce::dsp::AudioBlock<SampleType>& block) {
+    // The plugin wrappers only hand over each parameter's latest value, not where in the block it
+    // moved - so the block is split at fixed points instead, and whatever changed by then (host or
+    // GUI, or the designer publishing) takes effect at the next one rather than at the next block.
+    // Checking costs a few atomic loads when nothing moved, and only the bands that did are redesigned.
+    auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += automationSubBlockSize) {
+        if (start > 0) {
+            updatePhaseMode();
+            updateFilters();
+            updateBypassRoute();
+        }
+
+        auto segment = block.getSubBlock(start, juce::jmin(automationSubBlockSize, numSamples - start));
+
+        if (isBypassCrossfading()) {
+            processBypassCrossfade(segment);
+        }
+        else if (isBypassDelayOnly()) {
+            processBypassDelay(segment);
+        }
+        else {
+            processEngine(segment);
+        }
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processEngine(const juce::dsp::AudioBlock<SampleType>& block) {
+    if (phaseModeMix.isSmoothing()) {
+        processPhaseModeCrossfade(block);
+    }
+    else if (linearPhase) {
+        processLinearPhase(block);
+    }
+    else {
+        processMinimumPhase(block);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBypassDelay(const juce::dsp::AudioBlock<SampleType>& block) {
+    auto& delay = getBypassDelay<SampleType>();
+    // Prepared for as many channels as linearPhaseBuffer
+    auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+
+    // Follows the latency reported for the engine selected, should it change while bypassed
+    delay.setDelay(static_cast<SampleType>(selectedLatencySamples.load()));
+
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        auto* samples = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i) {
+            delay.pushSample(static_cast<int>(channel), samples[i]);
+            samples[i] = delay.popSample(static_cast<int>(channel));
+        }
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBypassCrossfade(const juce::dsp::AudioBlock<SampleType>& block) {
+    auto& delay = getBypassDelay<SampleType>();
+    auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+    auto numSamples = block.getNumSamples();
+    jassert(numSamples <= automationSubBlockSize);
+
+    std::array<SampleType, automationSubBlockSize> delayGains;
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        delayGains[i] = static_cast<SampleType>(bypassDelayMix.getNextValue());
+    }
+
+    delay.setDelay(static_cast<SampleType>(selectedLatencySamples.load()));
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    // The delay's share of the input goes in before any of its output comes out - its read and
+    // write positions move on their own, and it has room for a segment on top of its delay - so
+    // the engines can run on their share in place
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        auto* samples = block.getChannelPointer(channel);
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+        for (size_t i = 0; i < numSamples; ++i) {
+            delay.pushSample(static_cast<int>(channel), delayGains[i] * samples[i]);
+            samples[i] *= SampleType(1) - delayGains[i];
+        }
+    }
+
+    processEngine(block);
+
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        auto* samples = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i) {
+            samples[i] += delay.popSample(static_cast<int>(channel));
+        }
+    }
+
+    if (bypassDelayMix.isSmoothing()) {
+        // Counted from the end of the ramp, which may come anywhere in the next segment. The delay
+        // lets out its input after exactly its delay, an engine within its tail
+        auto fadingOutSamples = bypassDelayMix.getTargetValue() < 0.5f ? getSelectedLatencySamples()
+                              : linearPhase || phaseModeMix.isSmoothing() ? linearPhaseEQ->getTailSamples()
+                              : getSelectedLatencySamples();
+        bypassDrainSamples = fadingOutSamples + static_cast<int>(automationSubBlockSize);
+        return;
+    }
+
+    bypassDrainSamples = juce::jmax(0, bypassDrainSamples - static_cast<int>(numSamples));
+
+    // The side faded out has nothing left worth keeping, and starts from silence next time
+    if (bypassDrainSamples == 0) {
+        if (bypassDelayMix.getCurrentValue() > 0.5f) {
+            resetEngines();
+        }
+        else {
+            delay.reset();
+        }
+    }
+}
+
+template<typename SampleType>
+bool SimpleEQAudioProcessor::hasDecayed(const juce::dsp::AudioBlock<SampleType>& output) const {
+    constexpr auto threshold = static_cast<SampleType>(silenceThreshold);
+
+    if (!isSilent(output, threshold)) {
+        return false;
+    }
+
+    // Holds exactly its delay's worth of input, and the engines don't run at all
+    if (isBypassDelayOnly()) {
+        return silentSamples >= getSelectedLatencySamples();
+    }
+
+    // Ramps and crossfades have to finish first, they only advance while processing
+    if (chainSmoother->isSmoothing() || phaseModeMix.isSmoothing() || isBypassCrossfading()) {
+        return false;
+    }
+
+    // An FIR's tail is exactly its length, and its partitions hold no state worth checking
+    if (linearPhase) {
+        return silentSamples >= linearPhaseEQ->getTailSamples();
+    }
+
+    // The oversampler's delay line has to have emptied out as well as the cascade
+    return silentSamples >= getSelectedLatencySamples() && cascade->isSilent(threshold);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processMinimumPhase(const juce::dsp::AudioBlock<SampleType>& block) {
+    auto* oversampler = getOversampler<SampleType>();
+
+    if (oversampler == nullptr) {
+        processCascade(block);
+        return;
+    }
+
+    auto numSamples = block.getNumSamples();
+
+    // In case the host sends a bigger block than the oversamplers were prepared for
+    for (size_t start = 0; start < numSamples; start += oversamplingBlockSize) {
+        auto subBlock = block.getSubBlock(start, juce::jmin(oversamplingBlockSize, numSamples - start));
+
+        processCascade(oversampler->processSamplesUp(subBlock));
+        oversampler->processSamplesDown(subBlock);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processCascade(const juce::dsp::AudioBlock<SampleType>& block) {
+    if (chainSmoother->isSmoothing()) {
+        processSmoothed(block);
+    }
+    else {
+        cascade->process(block);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSmoothed(const juce::dsp::AudioBlock<SampleType>& block) {
+    // Redesign once per fixed sub-block while ramping, so the result doesn't depend on the host's block size
+    auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += smoothingSubBlockSize) {
+        auto subBlockSize = juce::jmin(smoothingSubBlockSize, numSamples - start);
+
+        if (chainSmoother->isSmoothing()) {
+            updateChainCoefficients(smoothedCoefficients,
+                                    chainSmoother->skip(static_cast<int>(subBlockSize)),
+                                    processingRate);
+            cascade->setCoefficients(smoothedCoefficients);
+        }
+
+        cascade->process(block.getSubBlock(start, subBlockSize));
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processLinearPhase(const juce::dsp::AudioBlock<SampleType>& block) {
+    if constexpr (std::is_same_v<SampleType, float>) {
+        linearPhaseEQ->process(block);
+    }
+    else {
+        // Converted to floats and back - an FIR has no feedback for rounding errors to build up in
+        auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+        auto numSamples = block.getNumSamples();
+        auto maxSubBlockSize = static_cast<size_t>(linearPhaseBuffer.getNumSamples());
+
+        for (size_t start = 0; start < numSamples; start += maxSubBlockSize) {
+            auto subBlockSize = juce::jmin(maxSubBlockSize, numSamples - start);
+            auto subBlock = block.getSubBlock(start, subBlockSize).getSubsetChannelBlock(0, numChannels);
+            auto linearPhaseBlock = juce::dsp::AudioBlock<float>(linearPhaseBuffer)
+                                        .getSubBlock(0, subBlockSize)
+                                        .getSubsetChannelBlock(0, numChannels);
+
+            copyConverting(linearPhaseBlock, subBlock);
+            linearPhaseEQ->process(linearPhaseBlock);
+            copyConverting(subBlock, linearPhaseBlock);
+        }
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processPhaseModeCrossfade(const juce::dsp::AudioBlock<SampleType>& block) {
+    auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+    auto numSamples = block.getNumSamples();
+    auto maxSubBlockSize = static_cast<size_t>(linearPhaseBuffer.getNumSamples());
+
+    // In case the host sends a bigger block than it announced
+    for (size_t start = 0; start < numSamples; start += maxSubBlockSize) {
+        auto subBlockSize = juce::jmin(maxSubBlockSize, numSamples - start);
+        auto minimumPhaseBlock = block.getSubBlock(start, subBlockSize).getSubsetChannelBlock(0, numChannels);
+        auto linearPhaseBlock = juce::dsp::AudioBlock<float>(linearPhaseBuffer)
+                                    .getSubBlock(0, subBlockSize)
+                                    .getSubsetChannelBlock(0, numChannels);
+
+        copyConverting(linearPhaseBlock, minimumPhaseBlock);
+
+        // linearPhaseEQ starts from silence and its output lags by its latency, so when it's
+        // switched to it's faded in at its input - otherwise the start of its history would
+        // come out as a step once the latency has passed
+        auto fadingIn = phaseModeMix.getTargetValue() > 0.5f;
+
+        if (fadingIn) {
+            auto inputMix = phaseModeMix;
+
+            for (size_t i = 0; i < subBlockSize; ++i) {
+                auto gain = inputMix.getNextValue();
 
-    juce::dsp::ProcessContextReplacing<float> leftContext (leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext (rightBlock);
+                for (size_t channel = 0; channel < numChannels; ++channel) {
+                    linearPhaseBlock.getChannelPointer(channel)[i] *= gain;
+                }
+            }
+        }
+
+        processMinimumPhase(minimumPhaseBlock);
+        linearPhaseEQ->process(linearPhaseBlock);
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+        for (size_t i = 0; i < subBlockSize; ++i) {
+            auto mix = static_cast<SampleType>(phaseModeMix.getNextValue());
+            auto linearPhaseGain = fadingIn ? SampleType(1) : mix;
+
+            for (size_t channel = 0; channel < numChannels; ++channel) {
+                auto& output = minimumPhaseBlock.getChannelPointer(channel)[i];
+                output = (SampleType(1) - mix) * output
+                       + linearPhaseGain * static_cast<SampleType>(linearPhaseBlock.getChannelPointer(channel)[i]);
+            }
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::updatePhaseMode() {
+    auto newLinearPhase = parameterTable->isLinearPhase();
+
+    if (newLinearPhase == linearPhase) {
+        return;
+    }
+
+    linearPhase = newLinearPhase;
+    linearPhaseEQ->setActive(linearPhase);
+    selectedLatencySamples = getSelectedLatencySamples();
+
+    // The engine being faded in starts from silence rather than from whatever it held when it was
+    // last used - unless it's still audible from a crossfade that hasn't finished
+    if (!phaseModeMix.isSmoothing()) {
+        if (linearPhase) {
+            linearPhaseEQ->reset();
+        }
+        else {
+            cascade->reset();
+        }
+    }
+
+    // While idle or bypassed both engines are silent, so there's nothing to crossfade between
+    if (idle || isBypassDelayOnly()) {
+        phaseModeMix.setCurrentAndTargetValue(linearPhase ? 1.f : 0.f);
+    }
+    else {
+        phaseModeMix.setTargetValue(linearPhase ? 1.f : 0.f);
+    }
+}
+
+void SimpleEQAudioProcessor::updateBypassRoute() {
+    auto bypassed = parameterTable->isBypassed() && !chainSmoother->getTargetValue().hasActiveBand();
+
+    if (bypassed == (bypassDelayMix.getTargetValue() > 0.5f)) {
+        return;
+    }
+
+    // Only once the bands have ramped out and the phase modes finished crossfading, as neither
+    // advances while bypassDelay alone runs - but straight back to the engines. Linear phase
+    // doesn't run chainSmoother, linearPhaseEQ fades its kernels in itself.
+    if (bypassed && ((!linearPhase && chainSmoother->isSmoothing()) || phaseModeMix.isSmoothing())) {
+        return;
+    }
+
+    // While idle both are silent, so there's nothing to crossfade between
+    if (idle) {
+        bypassDelayMix.setCurrentAndTargetValue(bypassed ? 1.f : 0.f);
+        bypassDrainSamples = 0;
+    }
+    else {
+        bypassDelayMix.setTargetValue(bypassed ? 1.f : 0.f);
+    }
+}
+
+void SimpleEQAudioProcessor::resetEngines() {
+    cascade->reset();
+    linearPhaseEQ->reset();
+
+    if (auto* oversampler = getOversampler<float>()) {
+        oversampler->reset();
+    }
+
+    if (auto* oversampler = getOversampler<double>()) {
+        oversampler->reset();
+    }
+}
+
+bool SimpleEQAudioProcessor::updateOversampling(double newProcessingRate) {
+    if (juce::approximatelyEqual(newProcessingRate, processingRate)) {
+        return false;
+    }
+
+    processingRate = newProcessingRate;
+
+    auto factor = juce::roundToInt(processingRate / getSampleRate());
+    oversamplingFactorLog2 = static_cast<size_t>(juce::jlimit(0, 2, juce::roundToInt(std::log2(factor))));
+
+    // Neither the cascade's state nor the half-band filters' carries over to another rate
+    cascade->reset();
+
+    if (auto* oversampler = getOversampler<float>()) {
+        oversampler->reset();
+    }
+
+    if (auto* oversampler = getOversampler<double>()) {
+        oversampler->reset();
+    }
+
+    chainSmoother->reset(processingRate, smoothingTime / 1000.0);
+    selectedLatencySamples = getSelectedLatencySamples();
+    return true;
+}
+
+int SimpleEQAudioProcessor::getSelectedLatencySamples() const {
+    if (linearPhase) {
+        return linearPhaseEQ->getLatencySamples();
+    }
+
+    // The same for both precisions, only one of which is prepared
+    if (auto* oversampler = getOversampler<float>()) {
+        return juce::roundToInt(oversampler->getLatencyInSamples());
+    }
+
+    if (auto* oversampler = getOversampler<double>()) {
+        return juce::roundToInt(oversampler->getLatencyInSamples());
+    }
+
+    return 0;
+}
+
+template<typename SampleType>
+juce::dsp::Oversampling<SampleType>* SimpleEQAudioProcessor::getOversampler() const {
+    if constexpr (std::is_same_v<SampleType, float>) {
+        return oversamplers[oversamplingFactorLog2].get();
+    }
+    else {
+        return doubleOversamplers[oversamplingFactorLog2].get();
+    }
+}
+
+template<typename SampleType>
+SimpleEQAudioProcessor::BypassDelay<SampleType>& SimpleEQAudioProcessor::getBypassDelay() {
+    if constexpr (std::is_same_v<SampleType, float>) {
+        return bypassDelay;
+    }
+    else {
+        return doubleBypassDelay;
+    }
+}
+
+void SimpleEQAudioProcessor::timerCallback() {
+    auto latency = selectedLatencySamples.load();
+
+    if (latency != getLatencySamples()) {
+        setLatencySamples(latency);
+    }
 }
 
 //==============================================================================
@@ -160,82 +789,590 @@ juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 }
 
 //==============================================================================
+// The standard CRC-32 (IEEE 802.3, reflected) of the state's values
+static juce::uint32 getStateChecksum(const void* data, size_t size) {
+    static const auto table = [] {
+        std::array<juce::uint32, 256> result {};
+
+        for (juce::uint32 i = 0; i < result.size(); ++i) {
+            auto c = i;
+
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1u) != 0 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+
+            result[i] = c;
+        }
+
+        return result;
+    }();
+
+    auto crc = 0xffffffffu;
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xffu] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xffffffffu;
+}
+
 void SimpleEQAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
-    juce::ignoreUnused(destData);
+    auto values = getParameterValues();
+    juce::MemoryOutputStream payload;
+
+    for (auto value : values) {
+        payload.writeFloat(value);
+    }
+
+    payload.writeInt(currentProgram);
+    payload.writeInt(numPrograms);
+
+    for (int program = 0; program < numPrograms; ++program) {
+        payload.writeString(presetBank->getName(program));
+
+        for (auto value : presetBank->getValues(program)) {
+            payload.writeFloat(value);
+        }
+    }
 
     juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    mos.writeInt(static_cast<int>(stateMagic));
+    mos.writeInt(stateVersion);
+    mos.writeInt(static_cast<int>(values.size()));
+    mos.writeInt(static_cast<int>(getStateChecksum(payload.getData(), payload.getDataSize())));
+    mos.write(payload.getData(), payload.getDataSize());
 }
 
 void SimpleEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
-    juce::ignoreUnused(data, sizeInBytes);
+    auto size = static_cast<size_t>(juce::jmax(0, sizeInBytes));
+
+    // The chain is designed once everything is in rather than after every parameter - and not at
+    // all until prepareToPlay if the designer isn't running yet
+    const CoefficientDesigner::ScopedBulkChange bulkChange(*coefficientDesigner);
+
+    if (size >= stateHeaderSize) {
+        juce::MemoryInputStream header(data, stateHeaderSize, false);
 
-    auto tree = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
+        if (static_cast<juce::uint32>(header.readInt()) == stateMagic) {
+            setBinaryState(data, size);
+            return;
+        }
+    }
+
+    // Sessions saved before the binary format hold the whole ValueTree
+    auto tree = juce::ValueTree::readFromData(data, size);
 
     if (tree.isValid()) {
         apvts.replaceState(tree);
-        updateFilters();
+    }
+}
+
+void SimpleEQAudioProcessor::setBinaryState(const void* data, size_t size) {
+    juce::MemoryInputStream header(data, stateHeaderSize, false);
+    header.readInt();
+    auto version = header.readInt();
+    auto numValues = header.readInt();
+    auto checksum = static_cast<juce::uint32>(header.readInt());
+
+    const auto* payload = static_cast<const char*>(data) + stateHeaderSize;
+    auto payloadSize = size - stateHeaderSize;
+    auto valuesSize = static_cast<size_t>(juce::jmax(0, numValues)) * sizeof(float);
+
+    // A damaged state, or one from a newer version, is left alone rather than half loaded
+    if (version < 1 || version > stateVersion || numValues < 0 || payloadSize < valuesSize
+        || (version == 1 && payloadSize != valuesSize)
+        || getStateChecksum(payload, payloadSize) != checksum) {
+        return;
+    }
+
+    juce::MemoryInputStream stream(payload, payloadSize, false);
+    setParameterValues(numValues, [&stream](int, juce::RangedAudioParameter&) { return stream.readFloat(); });
+    // Past any values for parameters this version doesn't have
+    stream.setPosition(static_cast<juce::int64>(valuesSize));
+
+    if (version < 2) {
+        return;
+    }
+
+    // The parameters above are the program as it was last edited, so nothing is recalled
+    auto program = stream.readInt();
+    auto numStoredPrograms = stream.readInt();
+
+    for (int index = 0; index < juce::jmin(numStoredPrograms, numPrograms); ++index) {
+        auto name = stream.readString();
+
+        if (stream.getNumBytesRemaining() < static_cast<juce::int64>(valuesSize)) {
+            break;
+        }
+
+        std::vector<float> values(static_cast<size_t>(numValues));
+
+        for (auto& value : values) {
+            value = stream.readFloat();
+        }
+
+        presetBank->setName(index, name);
+        presetBank->setValues(index, std::move(values));
+    }
+
+    currentProgram = juce::isPositiveAndBelow(program, numPrograms) ? program : 0;
+}
+
+std::vector<float> SimpleEQAudioProcessor::getParameterValues() const {
+    // Read from the parameters themselves, which are always current - apvts.state only catches
+    // up on the message thread's timer
+    std::vector<float> values;
+
+    for (auto* parameter : getParameters()) {
+        auto* rangedParameter = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        jassert(rangedParameter != nullptr);
+        values.push_back(rangedParameter->convertFrom0to1(rangedParameter->getValue()));
+    }
+
+    return values;
+}
+
+template<typename ReadValue>
+void SimpleEQAudioProcessor::setParameterValues(int numValues, ReadValue&& readValue) {
+    const auto& parameters = getParameters();
+
+    for (int i = 0; i < parameters.size(); ++i) {
+        auto* rangedParameter = dynamic_cast<juce::RangedAudioParameter*>(parameters[i]);
+        jassert(rangedParameter != nullptr);
+
+        // Parameters added since the values were saved go back to their defaults, as with replaceState()
+        auto value = i < numValues ? rangedParameter->convertTo0to1(readValue(i, *rangedParameter))
+                                   : rangedParameter->getDefaultValue();
+
+        if (!juce::approximatelyEqual(value, rangedParameter->getValue())) {
+            rangedParameter->setValueNotifyingHost(value);
+        }
     }
 }
 
 void SimpleEQAudioProcessor::updateFilters() {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    cascade->setTopology(parameterTable->getTopology());
+
+    auto newSmoothingTime = parameterTable->getSmoothingTime();
+
+    if (!juce::approximatelyEqual(newSmoothingTime, smoothingTime)) {
+        smoothingTime = newSmoothingTime;
+        chainSmoother->reset(processingRate, smoothingTime / 1000.0);
+    }
+
+    const ChainCoefficients* designed = nullptr;
+    auto program = pendingProgram.exchange(-1);
+
+    // Offline renders design inline, to stay in sync with automation
+    if (isNonRealtime()) {
+        auto generation = parameterTable->getGeneration();
+        auto rate = parameterTable->getProcessingSampleRate(getSampleRate());
+
+        // Most blocks of a render don't move any parameter, and then there's nothing to read
+        if (generation != inlineGeneration || !juce::approximatelyEqual(rate, inlineCoefficients.sampleRate)) {
+            updateChainCoefficients(inlineCoefficients, parameterTable->getChainSettings(), rate);
+            inlineGeneration = generation;
+        }
+
+        designed = &inlineCoefficients;
+
+        // The kernel too, but only when it's used and the settings moved - it's far costlier than biquads
+        const auto& chainSettings = designed->chainSettings;
+
+        if ((linearPhase || phaseModeMix.isSmoothing())
+            && !(linearPhaseSettings.has_value() && linearPhaseSettings->hasSameBands(chainSettings))) {
+            linearPhaseEQ->designNow(*designed);
+            linearPhaseSettings = chainSettings;
+        }
+    }
+    else {
+        designed = coefficientDesigner->pull();
+
+        if (program >= 0) {
+            designed = getProgramCoefficients(program, designed);
+        }
+        else if (designed != nullptr && programSettings.has_value()) {
+            // Until something moves after a program switch, anything else the designer publishes
+            // was started before the switch
+            if (parameterTable->hasChangedSince(programGeneration) || designed->chainSettings.hasSameBands(*programSettings)) {
+                programSettings.reset();
+            }
+            else {
+                designed = nullptr;
+            }
+        }
+
+        if (designed != nullptr) {
+            // Designed on linearPhaseEQ's own thread, whenever it's active
+            linearPhaseEQ->setCoefficients(*designed);
+            linearPhaseSettings.reset();
+        }
+    }
+
+    if (designed == nullptr) {
+        return;
+    }
+
+    chainTailSeconds = getChainTailSeconds(*designed);
+
+    // Coefficients for another oversampling factor are jumped to, there's nothing to ramp from -
+    // and so are any while idle, as the ramp would only advance once the input came back
+    auto rateChanged = updateOversampling(designed->sampleRate);
+
+    if (!rateChanged && !idle) {
+        chainSmoother->setTargetValue(designed->chainSettings);
+
+        // processSmoothed() ramps the cascade towards the new settings. Bands being bypassed or
+        // brought back ramp even with no smoothing time, anything else jumps straight there
+        if (chainSmoother->isSmoothing()) {
+            return;
+        }
+    }
+
+    cascade->setCoefficients(*designed);
+    chainSmoother->setCurrentAndTargetValue(designed->chainSettings);
+}
+
+const ChainCoefficients* SimpleEQAudioProcessor::getProgramCoefficients(int program, const ChainCoefficients* designed) {
+    // Read before the settings, so a change that lands while comparing lets the designer's through
+    programGeneration = parameterTable->getGeneration();
+
+    // Only when they're for the settings the parameters describe now, "Morph" included - not while
+    // bypassed, as programs are stored without their bypass. The settings are read in one go, so
+    // they can't mix one morph amount with another.
+    auto* coefficients = presetBank->getCoefficients(program, parameterTable->getProcessingSampleRate(getSampleRate()));
+
+    if (coefficients == nullptr || !coefficients->chainSettings.hasSameBands(parameterTable->getChainSettings())) {
+        programSettings.reset();
+        return designed;
+    }
+
+    programSettings = coefficients->chainSettings;
+    return coefficients;
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
-    ChainSettings chainSettings;
+ChainSettings interpolateChainSettings(const ChainSettings& from, const ChainSettings& to, float amount) {
+    auto logarithmic = [amount](float a, float b) { return a * std::pow(b / a, amount); };
+    auto linear = [amount](float a, float b) { return a + (b - a) * amount; };
 
-    chainSettings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    chainSettings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    chainSettings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    chainSettings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    chainSettings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    chainSettings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    chainSettings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    // A slope or type can't blend, so it switches halfway - with its band faded out through its
+    // mix on the way there and back in after, over the amounts within 0.1 of halfway
+    auto switched = amount >= 0.5f;
+    auto switchMix = juce::jmin(1.f, std::abs(2.f * amount - 1.f) / 0.2f);
+
+    auto chainSettings = from;
+    chainSettings.lowCutFreq = logarithmic(from.lowCutFreq, to.lowCutFreq);
+    chainSettings.highCutFreq = logarithmic(from.highCutFreq, to.highCutFreq);
+
+    if (from.lowCutSlope != to.lowCutSlope) {
+        chainSettings.lowCutSlope = switched ? to.lowCutSlope : from.lowCutSlope;
+        chainSettings.lowCutMix *= switchMix;
+    }
+
+    if (from.highCutSlope != to.highCutSlope) {
+        chainSettings.highCutSlope = switched ? to.highCutSlope : from.highCutSlope;
+        chainSettings.highCutMix *= switchMix;
+    }
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        auto& peak = chainSettings.peaks[band];
+        peak.freq = logarithmic(from.peaks[band].freq, to.peaks[band].freq);
+        peak.gainInDecibels = linear(from.peaks[band].gainInDecibels, to.peaks[band].gainInDecibels);
+        peak.quality = logarithmic(from.peaks[band].quality, to.peaks[band].quality);
+
+        if (from.peaks[band].type != to.peaks[band].type) {
+            peak.type = switched ? to.peaks[band].type : from.peaks[band].type;
+            peak.mix *= switchMix;
+        }
+    }
 
     return chainSettings;
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings) {
+const std::array<PeakParameterIDs, numPeakBands>& getPeakParameterIDs() {
+    // Built once, so looking parameters up never has to put their names together
+    static const auto ids = [] {
+        std::array<PeakParameterIDs, numPeakBands> result;
+
+        for (size_t band = 0; band < numPeakBands; ++band) {
+            auto prefix = band == 0 ? juce::String("Peak ") : "Peak " + juce::String(static_cast<int>(band) + 1) + " ";
+            result[band] = {prefix + "Freq", prefix + "Gain", prefix + "Quality", prefix + "Type", prefix + "Bypassed"};
+        }
+
+        return result;
+    }();
+
+    return ids;
+}
+
+// Matched second order designs after M. Vicanek, "Matched Second Order Digital Filters" (2016).
+// The poles are the analog prototype's mapped by impulse invariance, and the zeros are solved for
+// so the squared magnitude equals the analog one at a few frequencies - so unlike the bilinear
+// transform nothing is warped, and a 15 kHz peak at 44.1 kHz keeps its width and its gain.
+// Both squared magnitudes are written as B0 phi0 + B1 phi1 + B2 phi2 with
+// phi0 = cos^2(w/2), phi1 = sin^2(w/2), phi2 = 4 phi0 phi1, which is linear in the B's.
+namespace {
+struct MatchedPoles {
+    double a1, a2;
+    // Squared magnitude of the denominator at w0, and its terms at DC and Nyquist
+    double atCentre, atDc, atNyquist;
+};
+
+MatchedPoles makeMatchedPoles(double w0, double quality) {
+    auto zeta = 1.0 / (2.0 * quality);
+    auto decay = std::exp(-zeta * w0);
+
+    MatchedPoles poles {};
+    poles.a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w0)
+                           : -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+    poles.a2 = decay * decay;
+
+    auto phi1 = juce::square(std::sin(w0 / 2.0));
+    auto phi0 = 1.0 - phi1;
+
+    poles.atDc = juce::square(1.0 + poles.a1 + poles.a2);
+    poles.atNyquist = juce::square(1.0 - poles.a1 + poles.a2);
+    poles.atCentre = poles.atDc * phi0 + poles.atNyquist * phi1 - 16.0 * poles.a2 * phi0 * phi1;
+    return poles;
+}
+
+// mix * H(z) + (1 - mix), the section blended with its own input. Only the zeros move, so a
+// section's state carries straight on while its mix ramps, and at 0 it passes its input untouched
+void mixWithInput(CoefficientArray& coefficients, double mix) {
+    for (size_t i = 0; i < 3; ++i) {
+        coefficients[i] = mix * coefficients[i] + (1.0 - mix) * coefficients[i + 3];
+    }
+}
+
+// Every section of a cut is blended by the band's mix. Blending only the band as a whole would
+// need a copy of its input - this ramps steadily enough not to click
+void mixWithInput(CutCoefficients& coefficients, Slope slope, float mix) {
+    for (size_t i = 0; i <= static_cast<size_t>(slope); ++i) {
+        mixWithInput(coefficients[i], static_cast<double>(mix));
+    }
+}
+
+CoefficientArray toCoefficientArray(double b0, double b1, double b2, const MatchedPoles& poles) {
+    return {b0, b1, b2, 1.0, poles.a1, poles.a2};
+}
+
+// The analog peak (s^2 + s A/Q + 1) / (s^2 + s/(A Q) + 1), A^2 being the gain, as used by
+// IIR::ArrayCoefficients::makePeakFilter - matched at DC, the centre frequency and Nyquist
+CoefficientArray makeMatchedPeak(double sampleRate, double frequency, double quality, double gain) {
+    // A cut is exactly the inverse of the boost by the same amount, and matching the boost is far
+    // more accurate - its poles are the cut's zeros, which sit too close to the unit circle to match
+    if (gain < 1.0) {
+        auto boost = makeMatchedPeak(sampleRate, frequency, quality, 1.0 / gain);
+        auto b0 = boost[0];
+        return {1.0 / b0, boost[4] / b0, boost[5] / b0, 1.0, boost[1] / b0, boost[2] / b0};
+    }
+
+    auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto a = std::sqrt(gain);
+    auto poles = makeMatchedPoles(w0, quality * a);
+
+    auto analogPower = [a, quality](double ratio) {
+        auto real = juce::square(1.0 - ratio * ratio);
+        return (real + juce::square(ratio * a / quality)) / (real + juce::square(ratio / (a * quality)));
+    };
+
+    auto phi1 = juce::square(std::sin(w0 / 2.0));
+    auto phi0 = 1.0 - phi1;
+
+    auto dc = poles.atDc;
+    auto nyquist = poles.atNyquist * analogPower(juce::MathConstants<double>::pi / w0);
+    auto mixed = (gain * gain * poles.atCentre - dc * phi0 - nyquist * phi1) / (4.0 * phi0 * phi1);
+
+    // Back from the squared magnitude terms: sqrt(dc) = b0 + b1 + b2, sqrt(nyquist) = b0 - b1 + b2
+    // and mixed = -4 b0 b2, taking the minimum phase roots
+    auto sum = 0.5 * (std::sqrt(dc) + std::sqrt(nyquist));
+    auto b0 = 0.5 * (sum + std::sqrt(juce::jmax(0.0, sum * sum + mixed)));
+    auto b1 = 0.5 * (std::sqrt(dc) - std::sqrt(nyquist));
+    auto b2 = -mixed / (4.0 * b0);
+
+    return toCoefficientArray(b0, b1, b2, poles);
+}
+
+// s^2 / (s^2 + s/Q + 1) - the double zero at DC is kept, the gain is matched at the cutoff
+CoefficientArray makeMatchedHighPass(double sampleRate, double frequency, double quality) {
+    auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto poles = makeMatchedPoles(w0, quality);
+    auto phi1 = juce::square(std::sin(w0 / 2.0));
+
+    auto b0 = quality * std::sqrt(poles.atCentre) / (4.0 * phi1);
+    return toCoefficientArray(b0, -2.0 * b0, b0, poles);
+}
+
+// 1 / (s^2 + s/Q + 1) - matched at DC and at the cutoff, with b2 = 0
+CoefficientArray makeMatchedLowPass(double sampleRate, double frequency, double quality) {
+    auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto poles = makeMatchedPoles(w0, quality);
+    auto phi1 = juce::square(std::sin(w0 / 2.0));
+    auto phi0 = 1.0 - phi1;
+
+    auto dc = poles.atDc;
+    auto nyquist = juce::jmax(0.0, (quality * quality * poles.atCentre - dc * phi0) / phi1);
+
+    auto b0 = 0.5 * (std::sqrt(dc) + std::sqrt(nyquist));
+    return toCoefficientArray(b0, std::sqrt(dc) - b0, 0.0, poles);
+}
+}
+
+// Shelves and notches are always bilinear - only bells have a matched design
+static CoefficientArray makePeakFilter(const PeakSettings& peak, FilterDesign filterDesign, double sampleRate) {
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<double>;
+    auto gain = juce::Decibels::decibelsToGain(static_cast<double>(peak.gainInDecibels));
+
+    switch (peak.type) {
+        case PeakType_LowShelf:
+            return ArrayCoefficients::makeLowShelf(sampleRate, peak.freq, peak.quality, gain);
+        case PeakType_HighShelf:
+            return ArrayCoefficients::makeHighShelf(sampleRate, peak.freq, peak.quality, gain);
+        case PeakType_Notch:
+            return ArrayCoefficients::makeNotch(sampleRate, peak.freq, peak.quality);
+        case PeakType_Bell:
+            break;
+    }
+
+    return filterDesign == FilterDesign_Matched
+         ? makeMatchedPeak(sampleRate, peak.freq, peak.quality, gain)
+         : ArrayCoefficients::makePeakFilter(sampleRate, peak.freq, peak.quality, gain);
+}
+
+CoefficientArray makePeakFilter(const ChainSettings& chainSettings, size_t band, double sampleRate) {
+    const auto& peak = chainSettings.peaks[band];
+    auto coefficients = makePeakFilter(peak, chainSettings.filterDesign, sampleRate);
+
+    mixWithInput(coefficients, peak.mix);
+    return coefficients;
+}
+
+// Q of each biquad in a Butterworth cascade of order 2 * (slope + 1), as used by
+// FilterDesign::designIIR*HighOrderButterworthMethod - computed once instead of on every redesign
+static const std::array<std::array<float, 4>, 4>& getButterworthQualities() {
+    static const auto qualities = [] {
+        std::array<std::array<float, 4>, 4> q {};
+
+        for (size_t slope = 0; slope < q.size(); ++slope) {
+            auto order = 2.0 * static_cast<double>(slope + 1);
+
+            for (size_t i = 0; i <= slope; ++i) {
+                auto angle = (2.0 * static_cast<double>(i) + 1.0) * juce::MathConstants<double>::pi / (order * 2.0);
+                q[slope][i] = static_cast<float>(1.0 / (2.0 * std::cos(angle)));
+            }
+        }
+
+        return q;
+    }();
+
+    return qualities;
+}
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate) {
     // order parameter - 2 for 12dB, 4 for 24 dB, etc...
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& lowLeftCut = leftChain.get<ChainPositions::LowCut>();
-    auto& lowRightCut = rightChain.get<ChainPositions::LowCut>();
+    const auto& qualities = getButterworthQualities()[static_cast<size_t>(chainSettings.lowCutSlope)];
+    CutCoefficients coefficients {};
+
+    for (size_t i = 0; i <= static_cast<size_t>(chainSettings.lowCutSlope); ++i) {
+        coefficients[i] = chainSettings.filterDesign == FilterDesign_Matched
+                        ? makeMatchedHighPass(sampleRate, chainSettings.lowCutFreq, qualities[i])
+                        : juce::dsp::IIR::ArrayCoefficients<double>::makeHighPass(sampleRate,
+                                                                                  chainSettings.lowCutFreq,
+                                                                                  qualities[i]);
+    }
+
+    mixWithInput(coefficients, chainSettings.lowCutSlope, chainSettings.lowCutMix);
+    return coefficients;
+}
+
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate) {
+    const auto& qualities = getButterworthQualities()[static_cast<size_t>(chainSettings.highCutSlope)];
+    CutCoefficients coefficients {};
 
-    updateCutFilter(lowLeftCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(lowRightCut, lowCutCoefficients, chainSettings.lowCutSlope);
+    for (size_t i = 0; i <= static_cast<size_t>(chainSettings.highCutSlope); ++i) {
+        coefficients[i] = chainSettings.filterDesign == FilterDesign_Matched
+                        ? makeMatchedLowPass(sampleRate, chainSettings.highCutFreq, qualities[i])
+                        : juce::dsp::IIR::ArrayCoefficients<double>::makeLowPass(sampleRate,
+                                                                                 chainSettings.highCutFreq,
+                                                                                 qualities[i]);
+    }
+
+    mixWithInput(coefficients, chainSettings.highCutSlope, chainSettings.highCutMix);
+    return coefficients;
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings) {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+void updateChainCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate) {
+    auto fullUpdate = !juce::approximatelyEqual(coefficients.sampleRate, sampleRate);
+
+    if (fullUpdate || !chainSettings.hasSameLowCut(coefficients.chainSettings)) {
+        coefficients.lowCut = makeLowCutFilter(chainSettings, sampleRate);
+    }
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        if (fullUpdate || !chainSettings.hasSamePeak(coefficients.chainSettings, band)) {
+            coefficients.peaks[band] = makePeakFilter(chainSettings, band, sampleRate);
+        }
+    }
+    if (fullUpdate || !chainSettings.hasSameHighCut(coefficients.chainSettings)) {
+        coefficients.highCut = makeHighCutFilter(chainSettings, sampleRate);
+    }
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    coefficients.chainSettings = chainSettings;
+    coefficients.sampleRate = sampleRate;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq,
-                                                               chainSettings.peakQuality,
-                                                               juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+// Largest pole radius of a biquad, 0 for one without feedback
+static double getPoleRadius(const CoefficientArray& coefficients) {
+    auto a1 = coefficients[4] / coefficients[3];
+    auto a2 = coefficients[5] / coefficients[3];
+    auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0) {
+        return std::sqrt(a2);
+    }
+
+    auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+// Long enough for the slowest decaying section in the chain to fall by 120 dB, doubled because
+// the cut filters cascade up to four sections with nearly the same pole, which lengthens the tail
+double getChainTailSeconds(const ChainCoefficients& coefficients) {
+    auto slowestRadius = 0.0;
+
+    forEachActiveSection(coefficients, [&slowestRadius](size_t, const CoefficientArray& section) {
+        slowestRadius = juce::jmax(slowestRadius, getPoleRadius(section));
+    });
+
+    constexpr double maxChainTailSeconds = 10.0;
+
+    if (slowestRadius <= 0.0) {
+        return 0.0;
+    }
+
+    if (slowestRadius >= 1.0) {
+        return maxChainTailSeconds;
+    }
+
+    auto samples = 2.0 * std::log(1.0e-6) / std::log(slowestRadius);
+    return juce::jmin(std::ceil(samples) / coefficients.sampleRate, maxChainTailSeconds);
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings) {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+void applyChainCoefficients(MonoChain& chain, const ChainCoefficients& coefficients) {
+    const auto& chainSettings = coefficients.chainSettings;
 
-    auto& highLeftCut = leftChain.get<ChainPositions::HighCut>();
-    auto& highRightCut = rightChain.get<ChainPositions::HighCut>();
+    updateCutFilter(chain.get<ChainPositions::LowCut>(), coefficients.lowCut, chainSettings.lowCutSlope);
+    updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, coefficients.peaks[0]);
+    updateCutFilter(chain.get<ChainPositions::HighCut>(), coefficients.highCut, chainSettings.highCutSlope);
 
-    updateCutFilter(highLeftCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(highRightCut, highCutCoefficients, chainSettings.highCutSlope);
+    chain.setBypassed<ChainPositions::LowCut>(!chainSettings.isLowCutActive());
+    chain.setBypassed<ChainPositions::Peak>(!chainSettings.isPeakActive(0));
+    chain.setBypassed<ChainPositions::HighCut>(!chainSettings.isHighCutActive());
 }
 
 template<typename ChainType, typename CoefficientType>
@@ -267,8 +1404,28 @@ void update(ChainType& chainType, const CoefficientType& coefficients) {
     chainType.template setBypassed<Index>(false);
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements) {
-    *old = *replacements;
+void updateCoefficients(Coefficients& old, const CoefficientArray& replacements) {
+    // Assigning raw coefficients reuses the existing storage, unlike copying a whole Coefficients object
+    std::array<float, 6> singlePrecision;
+    std::transform(replacements.begin(), replacements.end(), singlePrecision.begin(),
+                   [](double coefficient) { return static_cast<float>(coefficient); });
+    *old = singlePrecision;
+}
+
+void reserveCoefficientStorage(MonoChain& chain) {
+    const CoefficientArray passThrough {1.0, 0.0, 0.0, 1.0, 0.0, 0.0};
+    auto& lowCut = chain.get<ChainPositions::LowCut>();
+    auto& highCut = chain.get<ChainPositions::HighCut>();
+
+    updateCoefficients(lowCut.get<0>().coefficients, passThrough);
+    updateCoefficients(lowCut.get<1>().coefficients, passThrough);
+    updateCoefficients(lowCut.get<2>().coefficients, passThrough);
+    updateCoefficients(lowCut.get<3>().coefficients, passThrough);
+    updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, passThrough);
+    updateCoefficients(highCut.get<0>().coefficients, passThrough);
+    updateCoefficients(highCut.get<1>().coefficients, passThrough);
+    updateCoefficients(highCut.get<2>().coefficients, passThrough);
+    updateCoefficients(highCut.get<3>().coefficients, passThrough);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout() {
@@ -303,6 +1460,72 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
 
+    // Ramp time in ms for parameter changes, 0 jumps straight to the new settings
+    layout.add(
+            std::make_unique<juce::AudioParameterFloat>("Smoothing Time", "Smoothing Time", juce::NormalisableRange<float>(
+                    0.f, 500.f, 1.f, 0.5f), 0.f));
+
+    // Linear phase runs the same magnitude response as a symmetric FIR, at the cost of latency
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "Phase Mode",
+                                                            juce::StringArray {"Minimum Phase", "Linear Phase"}, 0));
+
+    // Runs the cascade at a multiple of the host rate, so the bilinear transform's warping moves out
+    // of the audible range - at the cost of CPU and a few samples of latency
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling",
+                                                            juce::StringArray {"Off", "2x", "4x"}, 0));
+
+    // Matched designs get close to the analog response at the host rate, without oversampling's cost
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Design", "Filter Design",
+                                                            juce::StringArray {"Bilinear", "Matched"}, 0));
+
+    // State variable filters cost a little more than biquads, but don't lose precision on low cuts
+    // at high sample rates
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Topology", "Filter Topology",
+                                                            juce::StringArray {"Biquad", "State Variable"}, 0));
+
+    // A bypassed band costs nothing once it has ramped out. After every parameter that came before
+    // them, so hosts that address parameters by index still find those in their places
+    layout.add(std::make_unique<juce::AudioParameterBool>("LowCut Bypassed", "LowCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Bypassed", "Peak Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Bypass", "Bypass", false));
+
+    // The first band's shape, then every other band. Added last, so the parameters that were
+    // there before keep their places for hosts that address them by index
+    const juce::StringArray peakTypes {"Bell", "Low Shelf", "High Shelf", "Notch"};
+    const auto& peakParameterIDs = getPeakParameterIDs();
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(peakParameterIDs[0].type, peakParameterIDs[0].type,
+                                                            peakTypes, PeakType_Bell));
+
+    for (size_t band = 1; band < numPeakBands; ++band) {
+        const auto& ids = peakParameterIDs[band];
+        // Spread out, so each one starts somewhere different - at 0 dB they don't do anything yet
+        auto defaultFreq = juce::mapToLog10((static_cast<float>(band) + 0.5f) / static_cast<float>(numPeakBands),
+                                            20.f, 20000.f);
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ids.freq, ids.freq, juce::NormalisableRange<float>(
+                20.f, 20000.f, 1.f, 0.25f), std::round(defaultFreq)));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ids.gain, ids.gain, juce::NormalisableRange<float>(
+                -24.f, 24.f, 0.5f, 1.f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ids.quality, ids.quality, juce::NormalisableRange<float>(
+                0.1f, 10.f, 0.05f, 1.f), 1.f));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(ids.type, ids.type, peakTypes, PeakType_Bell));
+        layout.add(std::make_unique<juce::AudioParameterBool>(ids.bypassed, ids.bypassed, false));
+    }
+
+    // Blends the settings towards the target program's, 0 is the parameters as they are
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph", "Morph", juce::NormalisableRange<float>(
+            0.f, 1.f, 0.001f, 1.f), 0.f));
+
+    juce::StringArray programNames;
+
+    for (int program = 1; program <= numPrograms; ++program) {
+        programNames.add("Program " + juce::String(program));
+    }
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Morph Target", "Morph Target", programNames, 0));
+
     return layout;
 }
 
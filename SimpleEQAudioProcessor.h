@@ -3,6 +3,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include <optional>
+
 enum Slope {
     Slope_12,
     Slope_24,
@@ -10,18 +12,117 @@ enum Slope {
     Slope_48
 };
 
+// How analog prototypes are turned into biquads - the bilinear transform squeezes everything
+// above a few kHz towards Nyquist, matched designs keep the analog magnitude response up to it
+enum FilterDesign {
+    FilterDesign_Bilinear,
+    FilterDesign_Matched
+};
+
+// How SIMDBiquadCascade runs each section - the response is the same either way, but a state
+// variable filter stays accurate for cutoffs far below the sample rate, where a biquad's doesn't
+enum FilterTopology {
+    FilterTopology_Biquad,
+    FilterTopology_StateVariable
+};
+
+// Shape of a parametric band - the first is the original "Peak" band
+enum PeakType {
+    PeakType_Bell,
+    PeakType_LowShelf,
+    PeakType_HighShelf,
+    PeakType_Notch
+};
+
+// How many parametric bands sit between the cuts. Bands that do nothing are left out of
+// processing altogether, so this only costs parameters - the CPU goes on the active ones.
+constexpr size_t numPeakBands = 16;
+
+// How many programs the processor keeps - see PresetBank
+constexpr int numPrograms = 8;
+
+struct PeakSettings {
+    float freq {0}, gainInDecibels {0}, quality {1.f};
+    PeakType type {PeakType_Bell};
+    // 1 normally, 0 once the band or the whole plugin is bypassed - see ChainSettings
+    float mix {1.f};
+
+    // At 0 dB bells and shelves pass the signal through untouched, a notch never does
+    bool isActive() const {
+        return mix > 0.f && (type == PeakType_Notch || !juce::approximatelyEqual(gainInDecibels, 0.f));
+    }
+
+    bool operator==(const PeakSettings& other) const {
+        return juce::approximatelyEqual(freq, other.freq)
+            && juce::approximatelyEqual(gainInDecibels, other.gainInDecibels)
+            && juce::approximatelyEqual(quality, other.quality)
+            && type == other.type && juce::approximatelyEqual(mix, other.mix);
+    }
+};
+
 struct ChainSettings {
-    float peakFreq {0}, peakGainInDecibels {0}, peakQuality {1.f};
+    std::array<PeakSettings, numPeakBands> peaks {};
     float lowCutFreq {0}, highCutFreq{0};
     Slope lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
+    FilterDesign filterDesign {FilterDesign_Bilinear};
+    // How much of each band is in - 1 normally, 0 once it or the whole plugin is bypassed, and in
+    // between while ChainSmoother ramps from one to the other
+    float lowCutMix {1.f}, highCutMix {1.f};
+
+    // Whether a band does anything at all - the ones that don't have no sections to run
+    bool isLowCutActive() const { return lowCutMix > 0.f; }
+    bool isPeakActive(size_t band) const { return peaks[band].isActive(); }
+    bool isHighCutActive() const { return highCutMix > 0.f; }
+    // Without any active band the chain passes its input straight through
+    bool hasActiveBand() const {
+        return isLowCutActive() || isHighCutActive()
+            || std::any_of(peaks.begin(), peaks.end(), [](const PeakSettings& peak) { return peak.isActive(); });
+    }
+
+    // Used to skip redesigning a band whose parameters haven't moved since the last update
+    bool hasSameLowCut(const ChainSettings& other) const {
+        return juce::approximatelyEqual(lowCutFreq, other.lowCutFreq) && lowCutSlope == other.lowCutSlope
+            && filterDesign == other.filterDesign && juce::approximatelyEqual(lowCutMix, other.lowCutMix);
+    }
+
+    bool hasSamePeak(const ChainSettings& other, size_t band) const {
+        return peaks[band] == other.peaks[band] && filterDesign == other.filterDesign;
+    }
+
+    bool hasSamePeaks(const ChainSettings& other) const {
+        return peaks == other.peaks && filterDesign == other.filterDesign;
+    }
+
+    bool hasSameHighCut(const ChainSettings& other) const {
+        return juce::approximatelyEqual(highCutFreq, other.highCutFreq) && highCutSlope == other.highCutSlope
+            && filterDesign == other.filterDesign && juce::approximatelyEqual(highCutMix, other.highCutMix);
+    }
+
+    bool hasSameBands(const ChainSettings& other) const {
+        return hasSameLowCut(other) && hasSamePeaks(other) && hasSameHighCut(other);
+    }
 };
 
+// The settings amount of the way from from to to (0..1). Frequencies and Qs move evenly on a log
+// scale and gains in dB, like ChainSmoother ramps them, so every point on the way is an ordinary
+// set of settings that designs to stable filters - which blending coefficients doesn't promise.
+// Slopes and types switch halfway, fading their band out and back in through its mix so the
+// switch doesn't click. The filter design and the bypasses are from's throughout.
+ChainSettings interpolateChainSettings(const ChainSettings& from, const ChainSettings& to, float amount);
+
 using Filter = juce::dsp::IIR::Filter<float>;
 // LowPass/HiPass slope - 12/24/36/48
 using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-// Whole chain - HiPass, BandPass, LowPass
+// Whole chain - HiPass, BandPass, LowPass. Only has room for the first peak band - it's kept as
+// the per-channel reference SIMDBiquadCascade is benchmarked against
 using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
 using Coefficients = Filter::CoefficientsPtr;
+// Raw biquad coefficients (b0, b1, b2, a0, a1, a2) - designed on the stack, so updates don't allocate.
+// Kept in double precision: a low cut at a high sample rate has its poles so close to z = 1 that
+// floats can't tell them apart, whatever precision the filters then run in.
+using CoefficientArray = std::array<double, 6>;
+// One biquad per Filter in a CutFilter, only the first (slope + 1) are used
+using CutCoefficients = std::array<CoefficientArray, 4>;
 
 enum ChainPositions {
     LowCut,
@@ -29,29 +130,78 @@ enum ChainPositions {
     HighCut
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+// Everything needed to update a MonoChain, together with the settings it was designed from
+struct ChainCoefficients {
+    ChainSettings chainSettings;
+    double sampleRate {0.0};
+    CutCoefficients lowCut {};
+    std::array<CoefficientArray, numPeakBands> peaks {};
+    CutCoefficients highCut {};
+};
+
+// Every section of the chain has a fixed slot, in chain order
+constexpr size_t firstLowCutSection = 0;
+constexpr size_t firstPeakSection = 4;
+constexpr size_t firstHighCutSection = firstPeakSection + numPeakBands;
+constexpr size_t maxNumChainSections = firstHighCutSection + 4;
+
+// Calls function(slot, sectionCoefficients) for each section that has an effect, in chain order -
+// the one place that decides which sections the engines, the response curve and the tail estimate
+// leave out
+template<typename Function>
+void forEachActiveSection(const ChainCoefficients& coefficients, Function&& function) {
+    const auto& chainSettings = coefficients.chainSettings;
+
+    for (size_t i = 0; chainSettings.isLowCutActive() && i <= static_cast<size_t>(chainSettings.lowCutSlope); ++i) {
+        function(firstLowCutSection + i, coefficients.lowCut[i]);
+    }
+
+    for (size_t band = 0; band < numPeakBands; ++band) {
+        if (chainSettings.isPeakActive(band)) {
+            function(firstPeakSection + band, coefficients.peaks[band]);
+        }
+    }
+
+    for (size_t i = 0; chainSettings.isHighCutActive() && i <= static_cast<size_t>(chainSettings.highCutSlope); ++i) {
+        function(firstHighCutSection + i, coefficients.highCut[i]);
+    }
+}
+
+// Parameter IDs of each peak band - "Peak Freq" and so on for the first, "Peak 2 Freq" for the second...
+struct PeakParameterIDs {
+    juce::String freq, gain, quality, type, bypassed;
+};
+
+const std::array<PeakParameterIDs, numPeakBands>& getPeakParameterIDs();
+
+void updateCoefficients(Coefficients& old, const CoefficientArray& replacements);
+CoefficientArray makePeakFilter(const ChainSettings& chainSettings, size_t band, double sampleRate);
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
+// Redesigns only the bands of coefficients whose settings differ from the ones they were designed with
+void updateChainCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, double sampleRate);
+void applyChainCoefficients(MonoChain& chain, const ChainCoefficients& coefficients);
+// How long the active sections ring on after their input stops, in seconds, capped at 10 s
+double getChainTailSeconds(const ChainCoefficients& coefficients);
+// Sizes every Filter's coefficient storage for a biquad up front, so later updates never reallocate
+void reserveCoefficientStorage(MonoChain& chain);
 
 template<int Index, typename ChainType, typename CoefficientType>
 void update(ChainType& chainType, const CoefficientType& coefficients);
 template<typename ChainType, typename CoefficientType>
 void updateCutFilter(ChainType& chainType, const CoefficientType& coefficients, const Slope& slope);
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-   return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                      sampleRate,
-                                                                                      2 * (chainSettings.lowCutSlope + 1));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                               sampleRate,
-                                                                               2 * (chainSettings.highCutSlope + 1));
-}
+class ParameterTable;
+class PresetBank;
+class CoefficientDesigner;
+class ChainSmoother;
+class SIMDBiquadCascade;
+class SampleFifo;
+class LinearPhaseEQ;
 
 //==============================================================================
-class SimpleEQAudioProcessor final : public juce::AudioProcessor
+class SimpleEQAudioProcessor final : public juce::AudioProcessor,
+                                     private juce::Timer
 {
 public:
     //==============================================================================
@@ -64,8 +214,11 @@ public:
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
+    // Double buffers run the cascade in double precision, for low cuts at high sample rates
+    bool supportsDoublePrecisionProcessing() const override;
+
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -79,6 +232,9 @@ public:
     bool isMidiEffect() const override;
     double getTailLengthSeconds() const override;
 
+    // "Bypass" - handled like the per-band bypasses, so the host's bypass ramps in and out too
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
     //==============================================================================
     int getNumPrograms() override;
     int getCurrentProgram() override;
@@ -94,13 +250,186 @@ public:
 
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
 
+    // apvts's parameters as typed handles, for reading them from any thread without lookups
+    const ParameterTable& getParameterTable() const { return *parameterTable; }
+
+    // Message thread - stores the parameters as they are now as the program at index
+    void storeProgram(int index);
+
+    // For the editor's spectrum analyzer, which enables them while it's open - until then
+    // processBlock doesn't touch them beyond checking the flag
+    void setAnalyzerEnabled(bool shouldBeEnabled) { analyzerEnabled = shouldBeEnabled; }
+    SampleFifo& getPreEqFifo() { return *preEqFifo; }
+    SampleFifo& getPostEqFifo() { return *postEqFifo; }
+
 private:
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // Lets SimpleEQBenchmark time updateFilters() on its own, and check what a program switch uses
+    friend struct ProcessorBenchmarkAccess;
+
+    // Loads a state written by getStateInformation(), whose magic has already been checked
+    void setBinaryState(const void* data, size_t size);
+    // Every parameter's value in its own units, in getParameters() order
+    std::vector<float> getParameterValues() const;
+    // Sets parameter i to readValue(i, parameter), in its own units, for each i < numValues in
+    // order and the rest back to their defaults. Only the ones that move notify the host and listeners.
+    template<typename ReadValue>
+    void setParameterValues(int numValues, ReadValue&& readValue);
+
     void updateFilters();
+    // The program's precomputed coefficients if they match the parameters, designed if they don't
+    const ChainCoefficients* getProgramCoefficients(int program, const ChainCoefficients* designed);
+    void updatePhaseMode();
+    // Routes the input through bypassDelay instead of the engines once "Bypass" has ramped every
+    // band out, and back as soon as it's off
+    void updateBypassRoute();
+    // Clears the cascade's, linearPhaseEQ's and the oversamplers' history
+    void resetEngines();
+    // Switches to the oversampler for coefficients designed at newProcessingRate, returns whether it changed
+    bool updateOversampling(double newProcessingRate);
+    // Latency of whichever engine is selected - the host only ever hears about the one being switched to
+    int getSelectedLatencySamples() const;
+    void timerCallback() override;
+
+    // processBlock() in either precision - the cascade and the oversamplers run in the buffer's
+    // precision, linearPhaseEQ and the analyzer in single precision either way
+    template<typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+    // Runs the engine in use on block, picking up parameter changes every automationSubBlockSize samples
+    template<typename SampleType>
+    void processSegmented(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processMinimumPhase(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processCascade(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processSmoothed(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processLinearPhase(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processPhaseModeCrossfade(const juce::dsp::AudioBlock<SampleType>& block);
+    // The engine in use, or the crossfade between the phase modes
+    template<typename SampleType>
+    void processEngine(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processBypassDelay(const juce::dsp::AudioBlock<SampleType>& block);
+    // At most automationSubBlockSize samples, so the segment fits in bypassDelay ahead of its delay
+    template<typename SampleType>
+    void processBypassCrossfade(const juce::dsp::AudioBlock<SampleType>& block);
+    // Whether the engine in use has nothing left to ring out, given the output it just produced
+    template<typename SampleType>
+    bool hasDecayed(const juce::dsp::AudioBlock<SampleType>& output) const;
+
+    // The oversampler for the current factor in the given precision, nullptr when not oversampling
+    template<typename SampleType>
+    juce::dsp::Oversampling<SampleType>* getOversampler() const;
+
+    // Whole samples only, so what comes out is exactly what went in
+    template<typename SampleType>
+    using BypassDelay = juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None>;
+    template<typename SampleType>
+    BypassDelay<SampleType>& getBypassDelay();
+    // Whether bypassDelay and the engines both run - while bypassDelayMix ramps, and after it until
+    // the side faded out has let out what it still held
+    bool isBypassCrossfading() const { return bypassDelayMix.isSmoothing() || bypassDrainSamples > 0; }
+    // Whether only bypassDelay runs, with the engines left alone
+    bool isBypassDelayOnly() const { return !isBypassCrossfading() && bypassDelayMix.getCurrentValue() > 0.5f; }
+
+    // While ramping, the cascade is redesigned every this many samples
+    static constexpr size_t smoothingSubBlockSize = 32;
+    // Parameters are checked again every this many samples of a block, at the host rate. A multiple
+    // of smoothingSubBlockSize, so ramps keep redesigning on the same grid
+    static constexpr size_t automationSubBlockSize = 64;
+    static_assert(automationSubBlockSize % smoothingSubBlockSize == 0);
+
+    // getStateInformation() writes, little endian, a header of stateMagic, stateVersion, the number
+    // of values and the CRC-32 of everything after the header, then every parameter's value in its
+    // own units as a float, in getParameters() order. Parameters are only ever added at the end of
+    // the layout, so states saved with fewer of them still line up.
+    // Since version 2 the values are followed by the current program, the number of programs and
+    // each program's name and values - version 1 states hold the values alone.
+    static constexpr juce::uint32 stateMagic = 0x51455153; // "SQEQ"
+    static constexpr int stateVersion = 2;
+    static constexpr size_t stateHeaderSize = 4 * sizeof(juce::int32);
+
+    std::unique_ptr<ParameterTable> parameterTable;
+
+    std::unique_ptr<PresetBank> presetBank;
+    int currentProgram {0};
+    // Set by setCurrentProgram() for the audio thread, which switches to the program's ready made
+    // coefficients on its next block instead of waiting for them to be designed. -1 for none.
+    std::atomic<int> pendingProgram {-1};
+    // The program switched to, until parameterTable's generation moves past programGeneration -
+    // coefficientDesigner may still publish a design it started before the switch, which is dropped
+    std::optional<ChainSettings> programSettings;
+    juce::uint32 programGeneration {0};
+
+    std::unique_ptr<CoefficientDesigner> coefficientDesigner;
+    // Designed inline instead of by coefficientDesigner when rendering offline, to stay in sync with
+    // automation - but only redesigned when parameterTable's generation moved past inlineGeneration
+    ChainCoefficients inlineCoefficients;
+    juce::uint32 inlineGeneration {0};
+
+    std::unique_ptr<ChainSmoother> chainSmoother;
+    ChainCoefficients smoothedCoefficients;
+    float smoothingTime {0.f};
+
+    // Processes every channel through the whole chain in one go
+    std::unique_ptr<SIMDBiquadCascade> cascade;
+
+    // Run the cascade at 2x or 4x the host rate, for cuts and peaks that keep their analog shape
+    // near Nyquist. Both are prepared up front, indexed by log2 of the factor, so switching never
+    // allocates - the switch happens when the first coefficients designed for the new rate arrive.
+    // Only the ones for the precision the host processes in are prepared.
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 3> oversamplers;
+    std::array<std::unique_ptr<juce::dsp::Oversampling<double>>, 3> doubleOversamplers;
+    size_t oversamplingFactorLog2 {0};
+    size_t oversamplingBlockSize {0};
+    // getSampleRate() times the oversampling factor in use
+    double processingRate {0.0};
+
+    // Replaces cascade while the "Phase Mode" parameter selects linear phase
+    std::unique_ptr<LinearPhaseEQ> linearPhaseEQ;
+    bool linearPhase {false};
+    // What linearPhaseEQ's kernel was designed from, when that's known for certain - offline
+    // renders redesign it inline whenever this doesn't match the settings
+    std::optional<ChainSettings> linearPhaseSettings;
+    // 0 for the cascade, 1 for linearPhaseEQ - while it ramps both run, the cascade on the block
+    // and linearPhaseEQ on a copy of it in linearPhaseBuffer
+    juce::SmoothedValue<float> phaseModeMix;
+    // linearPhaseEQ's input and output - the block copied for a crossfade, or converted to floats
+    // when the host processes doubles
+    juce::AudioBuffer<float> linearPhaseBuffer;
+    static constexpr double phaseModeCrossfadeSeconds = 0.02;
+
+    // With "Bypass" on, the engines would only delay the input by their latency - at the full cost
+    // of oversampling or of the FFT convolution. Once the bands have ramped out the input goes
+    // through bypassDelay instead, delayed by exactly the latency the host was told about.
+    // 0 for the engines, 1 for bypassDelay - while it ramps both run, on the input faded in for one
+    // and out for the other, so what the one coming in starts out with doesn't matter. The one
+    // faded out keeps running on silence until what it held has come out, bypassDrainSamples more.
+    // Only the one for the precision the host processes in is prepared.
+    BypassDelay<float> bypassDelay;
+    BypassDelay<double> doubleBypassDelay;
+    juce::SmoothedValue<float> bypassDelayMix;
+    int bypassDrainSamples {0};
+    static constexpr double bypassDelayCrossfadeSeconds = 0.01;
+
+    // Set on the audio thread whenever the engine changes and handed to the host by timerCallback(),
+    // as setLatencySamples() may lock or allocate
+    std::atomic<int> selectedLatencySamples {0};
+    static constexpr int latencyPollIntervalMs = 50;
+
+    // Once the input has stayed below silenceThreshold for long enough that the engine in use has
+    // nothing left to ring out, processBlock skips the DSP and outputs silence until it rises again
+    static constexpr double silenceThreshold = 1.0e-6;
+    juce::int64 silentSamples {0};
+    bool idle {false};
+    // How long the cascade rings for with the coefficients it was last given, for getTailLengthSeconds()
+    std::atomic<double> chainTailSeconds {0.0};
 
-    MonoChain leftChain, rightChain;
+    // Each block's input and output, mixed down to mono
+    std::unique_ptr<SampleFifo> preEqFifo, postEqFifo;
+    std::atomic<bool> analyzerEnabled {false};
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
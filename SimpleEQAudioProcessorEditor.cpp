@@ -1,6 +1,7 @@
 #include <juce_gui_extra/misc/juce_LiveConstantEditor.h>
 #include "SimpleEQAudioProcessor.h"
 #include "SimpleEQAudioProcessorEditor.h"
+#include "ParameterTable.h"
 
 void LookAndFeel::drawRotarySlider(juce::Graphics &g, int x, int y, int width, int height, float sliderPosProportional,
                                    float rotaryStartAngle, float rotaryEndAngle, juce::Slider &slider) {
@@ -134,122 +135,51 @@ juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const {
 
 //==============================================================================
 
-ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : processorRef(p) {
-    const auto& params = processorRef.getParameters();
-
-    for (auto* param : params) {
-        param->addListener(this);
-    }
-
-    updateChain();
-
-    startTimerHz(60);
+ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : processorRef(p), renderer(p) {
+    setOpaque(true);
+    startTimerHz(visibleRateHz);
 }
 
-ResponseCurveComponent::~ResponseCurveComponent() {
-    const auto& params = processorRef.getParameters();
+void ResponseCurveComponent::timerCallback() {
+    auto rateHz = isShowing() ? visibleRateHz : hiddenRateHz;
 
-    for (auto* param : params) {
-        param->removeListener(this);
+    if (getTimerInterval() != 1000 / rateHz) {
+        startTimerHz(rateHz);
     }
-}
-
 
-void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue) {
-    parametersChanged.set(true);
-}
+    // Nothing is drawn, and nothing repainted, unless something actually changed
+    if (processorRef.getParameterTable().hasChangedSince(requestedGeneration)
+        || !juce::approximatelyEqual(processorRef.getSampleRate(), sampleRate)
+        || renderer.hasNewAudio()) {
+        requestFrame();
+    }
 
-void ResponseCurveComponent::timerCallback() {
-    if (parametersChanged.compareAndSetBool(false, true)) {
-        // update monochain
-        updateChain();
-        // signal a repaint
+    if (renderer.pull() != nullptr) {
         repaint();
     }
 }
 
-void ResponseCurveComponent::updateChain() {
-    auto chainSettings = getChainSettings(processorRef.apvts);
-    auto peakCoefficients = makePeakFilter(chainSettings, processorRef.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, processorRef.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, processorRef.getSampleRate());
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+void ResponseCurveComponent::requestFrame() {
+    requestedGeneration = processorRef.getParameterTable().getGeneration();
+    sampleRate = processorRef.getSampleRate();
+    renderer.requestFrame(getWidth(), getHeight(),
+                          juce::Component::getApproximateScaleFactorForComponent(this), sampleRate);
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g) {
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (juce::Colours::black);
-
-    auto responseArea = getLocalBounds();
-    auto width = responseArea.getWidth();
-
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
-
-    auto sampleRate = processorRef.getSampleRate();
-
-    std::vector<double> mags;
-    mags.resize(static_cast<unsigned long>(width));
-
-    for (int i = 0; i < width; ++i) {
-        double mag = 1.f;
-        auto freq = juce::mapToLog10(static_cast<double>(i) / static_cast<double>(width), 20.0, 20000.0);
+    const auto& frame = renderer.getFrame();
 
-        if (!monoChain.isBypassed<ChainPositions::Peak>()) {
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if (!lowCut.isBypassed<0>()) {
-            mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<1>()) {
-            mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<2>()) {
-            mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!lowCut.isBypassed<3>()) {
-            mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        if (!highCut.isBypassed<0>()) {
-            mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<1>()) {
-            mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<2>()) {
-            mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if (!highCut.isBypassed<3>()) {
-            mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-
-        mags[static_cast<unsigned long>(i)] = juce::Decibels::gainToDecibels(mag);
+    // Nothing to blit until the first frame is finished
+    if (frame.isNull()) {
+        g.fillAll(juce::Colours::black);
+        return;
     }
 
-    juce::Path responseCurve;
-
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input) {
-        return juce::jmap(input, -24.0, 24.0, outputMin, outputMax);
-    };
-
-    responseCurve.startNewSubPath(static_cast<float>(responseArea.toFloat().getX()), static_cast<float>(map(mags.front())));
-
-    for (size_t i = 1; i < mags.size(); ++i) {
-        responseCurve.lineTo(static_cast<float>(responseArea.getX() + i), static_cast<float>(map(mags[i])));
-    }
+    g.drawImage(frame, getLocalBounds().toFloat());
+}
 
-    g.setColour(juce::Colours::orange);
-    g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
-    g.setColour(juce::Colours::white);
-    g.strokePath(responseCurve, juce::PathStrokeType(2.f));
+void ResponseCurveComponent::resized() {
+    requestFrame();
 }
 
 //==============================================================================
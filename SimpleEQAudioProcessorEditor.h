@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SimpleEQAudioProcessor.h"
+#include "ResponseCurveRenderer.h"
 
 struct LookAndFeel : juce::LookAndFeel_V4 {
     void drawRotarySlider (juce::Graphics& g,
@@ -40,22 +41,28 @@ private:
     juce::String suffix;
 };
 
-struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener,
-                                juce::Timer {
+struct ResponseCurveComponent : juce::Component, juce::Timer {
     ResponseCurveComponent(SimpleEQAudioProcessor&);
-    ~ResponseCurveComponent();
 
-    void parameterValueChanged(int parameterIndex, float newValue) override;
-    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
     void timerCallback() override;
     void paint (juce::Graphics&) override;
+    void resized() override;
 
 private:
-    void updateChain();
+    void requestFrame();
+
+    // The timer only polls for changes and finished frames - while the editor can't be seen it
+    // drops to a low rate, so the curve is kept roughly current without drawing at full rate
+    static constexpr int visibleRateHz = 60;
+    static constexpr int hiddenRateHz = 4;
 
     SimpleEQAudioProcessor& processorRef;
-    juce::Atomic<bool> parametersChanged {false};
-    MonoChain monoChain;
+    // The parameters' generation when the last frame was requested
+    juce::uint32 requestedGeneration {0};
+    double sampleRate {0.0};
+
+    // Drawn on a background thread, so paint just blits the last finished frame
+    ResponseCurveRenderer renderer;
 };
 
 //==============================================================================
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+// Lock-free single-writer/multi-reader publication of a value. The writer copies the current
+// snapshot into a slot no reader holds, changes it there and makes it current; readers hold the
+// current slot while they read it, so nothing they see changes underneath them. Readers never
+// wait - only the writer does, when more readers than there are spare slots hold old snapshots.
+template<typename Type, size_t numSlots = 4>
+class SnapshotBuffer {
+public:
+    // Writer side - one thread at a time. modify(Type&) changes a copy of the current snapshot.
+    template<typename Modify>
+    void modify(Modify&& modifySnapshot) {
+        auto current = currentIndex.load();
+        auto slot = findUnheldSlot(current);
+
+        slots[slot] = slots[current];
+        modifySnapshot(slots[slot]);
+        currentIndex.store(slot);
+    }
+
+    // Any thread - returns read(const Type&) of the current snapshot
+    template<typename Read>
+    auto read(Read&& readSnapshot) const noexcept {
+        const Hold hold(*this);
+        return readSnapshot(slots[hold.index]);
+    }
+
+private:
+    // Takes a hold on the current slot. Sequentially consistent with the writer's store of
+    // currentIndex and its check of the holds: either the writer sees the hold, or this sees that
+    // the slot stopped being current and tries again.
+    struct Hold {
+        explicit Hold(const SnapshotBuffer& b) noexcept : buffer(b) {
+            for (;;) {
+                index = buffer.currentIndex.load();
+                buffer.holds[index].fetch_add(1);
+
+                if (buffer.currentIndex.load() == index) {
+                    return;
+                }
+
+                buffer.holds[index].fetch_sub(1);
+            }
+        }
+
+        ~Hold() { buffer.holds[index].fetch_sub(1); }
+
+        const SnapshotBuffer& buffer;
+        size_t index {0};
+    };
+
+    size_t findUnheldSlot(size_t current) const {
+        for (;;) {
+            for (size_t slot = 0; slot < numSlots; ++slot) {
+                if (slot != current && holds[slot].load() == 0) {
+                    return slot;
+                }
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    std::array<Type, numSlots> slots {};
+    std::atomic<size_t> currentIndex {0};
+    mutable std::array<std::atomic<int>, numSlots> holds {};
+};
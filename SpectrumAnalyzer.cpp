@@ -0,0 +1,165 @@
+#include "SpectrumAnalyzer.h"
+
+SampleFifo::SampleFifo() : samples(static_cast<size_t>(capacity)) {}
+
+void SampleFifo::push(const juce::dsp::AudioBlock<float>& block) {
+    pushMixedDown(block);
+}
+
+void SampleFifo::push(const juce::dsp::AudioBlock<double>& block) {
+    pushMixedDown(block);
+}
+
+template<typename SampleType>
+void SampleFifo::pushMixedDown(const juce::dsp::AudioBlock<SampleType>& block) {
+    auto numChannels = static_cast<int>(block.getNumChannels());
+
+    if (numChannels == 0) {
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(static_cast<int>(block.getNumSamples()), start1, size1, start2, size2);
+
+    auto gain = 1.f / static_cast<float>(numChannels);
+
+    auto mixDown = [&](int destinationStart, int sourceStart, int numSamples) {
+        if (numSamples <= 0) {
+            return;
+        }
+
+        auto* destination = samples.data() + destinationStart;
+
+        if constexpr (std::is_same_v<SampleType, float>) {
+            juce::FloatVectorOperations::copyWithMultiply(destination, block.getChannelPointer(0) + sourceStart,
+                                                          gain, numSamples);
+
+            for (int channel = 1; channel < numChannels; ++channel) {
+                juce::FloatVectorOperations::addWithMultiply(destination,
+                                                             block.getChannelPointer(static_cast<size_t>(channel)) + sourceStart,
+                                                             gain, numSamples);
+            }
+        }
+        else {
+            // FloatVectorOperations has nothing that mixes doubles into floats
+            std::fill(destination, destination + numSamples, 0.f);
+
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const auto* source = block.getChannelPointer(static_cast<size_t>(channel)) + sourceStart;
+
+                for (int i = 0; i < numSamples; ++i) {
+                    destination[i] += gain * static_cast<float>(source[i]);
+                }
+            }
+        }
+    };
+
+    mixDown(start1, 0, size1);
+    mixDown(start2, size1, size2);
+    fifo.finishedWrite(size1 + size2);
+}
+
+int SampleFifo::pop(float* destination, int numSamples) {
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+    if (size1 > 0) {
+        juce::FloatVectorOperations::copy(destination, samples.data() + start1, size1);
+    }
+
+    if (size2 > 0) {
+        juce::FloatVectorOperations::copy(destination + size1, samples.data() + start2, size2);
+    }
+
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+void SampleFifo::discard(int numSamples) {
+    fifo.finishedRead(juce::jmin(numSamples, fifo.getNumReady()));
+}
+
+//==============================================================================
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : input(static_cast<size_t>(fftSize)),
+      fftData(static_cast<size_t>(2 * fftSize)),
+      averagedPowers(static_cast<size_t>(fftSize / 2 + 1)) {}
+
+bool SpectrumAnalyzer::process(SampleFifo& fifo, double sampleRate) {
+    // Whatever can't make it into the last few FFTs would be averaged away anyway. Skipping
+    // ahead breaks the continuity with what's buffered, so that's started over too.
+    constexpr auto maxSamplesPerProcess = fftSize + (maxFftsPerProcess - 1) * hopSize;
+
+    if (fifo.getNumReady() > maxSamplesPerProcess - numBuffered) {
+        numBuffered = 0;
+        fifo.discard(fifo.getNumReady() - maxSamplesPerProcess);
+    }
+
+    // Each FFT's weight in the average, so the averaging time doesn't depend on the sample rate
+    auto weight = static_cast<float>(1.0 - std::exp(-hopSize / (averagingTimeSeconds * sampleRate)));
+    auto analysed = false;
+
+    while (true) {
+        numBuffered += fifo.pop(input.data() + numBuffered, fftSize - numBuffered);
+
+        if (numBuffered < fftSize) {
+            return analysed;
+        }
+
+        std::copy(input.begin(), input.end(), fftData.begin());
+        window.multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(fftSize));
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        // The normalised window has a mean of one, so a full scale sine peaks at fftSize / 2
+        constexpr auto scale = 2.f / static_cast<float>(fftSize);
+
+        for (size_t bin = 0; bin < averagedPowers.size(); ++bin) {
+            auto magnitude = fftData[bin] * scale;
+            averagedPowers[bin] += weight * (magnitude * magnitude - averagedPowers[bin]);
+        }
+
+        std::copy(input.begin() + hopSize, input.end(), input.begin());
+        numBuffered -= hopSize;
+        analysed = true;
+    }
+}
+
+void SpectrumAnalyzer::createPath(juce::Path& path, int width, int height, double sampleRate) const {
+    path.clear();
+
+    if (width <= 0 || sampleRate <= 0.0) {
+        return;
+    }
+
+    const double outputMin = height;
+    const double outputMax = 0.0;
+    auto binsPerHz = fftSize / sampleRate;
+    auto lastBin = static_cast<double>(averagedPowers.size() - 1);
+
+    path.preallocateSpace(3 * width);
+
+    for (int x = 0; x < width; ++x) {
+        auto freq = juce::mapToLog10(static_cast<double>(x) / static_cast<double>(width), 20.0, 20000.0);
+        auto bin = juce::jmin(freq * binsPerHz, lastBin);
+
+        // Linear interpolation of the power between the two nearest bins
+        auto lower = static_cast<size_t>(bin);
+        auto upper = juce::jmin(lower + 1, averagedPowers.size() - 1);
+        auto fraction = static_cast<float>(bin - static_cast<double>(lower));
+        auto power = averagedPowers[lower] + fraction * (averagedPowers[upper] - averagedPowers[lower]);
+
+        // Half the dB of the power is the dB of the magnitude
+        auto decibels = juce::jmax(0.5f * juce::Decibels::gainToDecibels(power, 2.f * minimumDecibels),
+                                   minimumDecibels);
+        auto y = static_cast<float>(juce::jmap(static_cast<double>(decibels),
+                                               static_cast<double>(minimumDecibels), 0.0, outputMin, outputMax));
+
+        if (x == 0) {
+            path.startNewSubPath(0.f, y);
+        }
+        else {
+            path.lineTo(static_cast<float>(x), y);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SimpleEQAudioProcessor.h"
+
+// Lock-free single-producer/single-consumer queue of mono samples, filled by processBlock
+// and drained by the editor's spectrum analyzer. The storage is allocated once up front,
+// and samples that don't fit because the consumer fell behind are simply dropped.
+class SampleFifo {
+public:
+    static constexpr int capacity = 1 << 15;
+
+    SampleFifo();
+
+    // Producer - mixes the block's channels down to one and pushes it
+    void push(const juce::dsp::AudioBlock<float>& block);
+    void push(const juce::dsp::AudioBlock<double>& block);
+
+    // Consumer
+    int getNumReady() const { return fifo.getNumReady(); }
+    int pop(float* destination, int numSamples);
+    void discard(int numSamples);
+
+private:
+    template<typename SampleType>
+    void pushMixedDown(const juce::dsp::AudioBlock<SampleType>& block);
+
+    juce::AbstractFifo fifo {capacity};
+    std::vector<float> samples;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleFifo)
+};
+
+// Averaged magnitude spectrum of whatever passes through a SampleFifo: Hann-windowed FFTs,
+// overlapping by three quarters, with each bin's power averaged exponentially over time.
+class SpectrumAnalyzer {
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    SpectrumAnalyzer();
+
+    // Drains the fifo, returning false if not a single new FFT was averaged in. Only the
+    // newest samples are analysed when more are waiting than a few FFTs' worth.
+    bool process(SampleFifo& fifo, double sampleRate);
+
+    // The averaged spectrum from 20 Hz to 20 kHz, spaced like ResponseCurve's points, over
+    // width x height pixels with 0 dBFS at the top and minimumDecibels at the bottom
+    void createPath(juce::Path& path, int width, int height, double sampleRate) const;
+
+    static constexpr float minimumDecibels = -72.f;
+
+private:
+    // How quickly the average follows the signal
+    static constexpr double averagingTimeSeconds = 0.1;
+    static constexpr int maxFftsPerProcess = 8;
+
+    juce::dsp::FFT fft {fftOrder};
+    juce::dsp::WindowingFunction<float> window {static_cast<size_t>(fftSize),
+                                                juce::dsp::WindowingFunction<float>::hann};
+
+    // The last fftSize samples, of which numBuffered are filled
+    std::vector<float> input;
+    int numBuffered {0};
+
+    // Twice the FFT size, as performFrequencyOnlyForwardTransform needs
+    std::vector<float> fftData;
+    // Averaged power of each bin up to Nyquist
+    std::vector<float> averagedPowers;
+};
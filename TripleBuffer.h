@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer handoff of the latest value.
+// The producer fills getWriteBuffer() and publishes it, the consumer pulls whatever
+// was published last - older values that were never pulled are simply overwritten.
+template<typename Type>
+class TripleBuffer {
+public:
+    // Producer side
+    Type& getWriteBuffer() { return slots[static_cast<size_t>(writeIndex)]; }
+
+    void publish() {
+        writeIndex = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Consumer side - returns nullptr if nothing was published since the last pull. The slot is the
+    // consumer's until the next pull, so it may swap the value out, as long as the producer gets
+    // back something it can write into.
+    Type* pull() {
+        if ((middle.load(std::memory_order_acquire) & freshFlag) == 0) {
+            return nullptr;
+        }
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return &slots[static_cast<size_t>(readIndex)];
+    }
+
+    const Type& getReadBuffer() const { return slots[static_cast<size_t>(readIndex)]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    std::array<Type, 3> slots {};
+    std::atomic<int> middle {1};
+    int writeIndex {0}, readIndex {2};
+};
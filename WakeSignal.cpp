@@ -0,0 +1,65 @@
+#include "WakeSignal.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+// macOS doesn't implement unnamed POSIX semaphores
+struct WakeSignal::Semaphore {
+    Semaphore() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Semaphore() { dispatch_release(semaphore); }
+
+    void post() noexcept { dispatch_semaphore_signal(semaphore); }
+    void wait() noexcept { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+
+    dispatch_semaphore_t semaphore;
+};
+#elif JUCE_WINDOWS
+struct WakeSignal::Semaphore {
+    Semaphore() : semaphore(CreateSemaphoreW(nullptr, 0, 1, nullptr)) {}
+    ~Semaphore() { CloseHandle(semaphore); }
+
+    void post() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait() noexcept { WaitForSingleObject(semaphore, INFINITE); }
+
+    HANDLE semaphore;
+};
+#else
+// glibc's sem_post is an atomic increment, and a futex wake only when someone is waiting
+struct WakeSignal::Semaphore {
+    Semaphore() { sem_init(&semaphore, 0, 0); }
+    ~Semaphore() { sem_destroy(&semaphore); }
+
+    void post() noexcept { sem_post(&semaphore); }
+
+    void wait() noexcept {
+        while (sem_wait(&semaphore) != 0 && errno == EINTR) {}
+    }
+
+    sem_t semaphore;
+};
+#endif
+
+WakeSignal::WakeSignal() : semaphore(std::make_unique<Semaphore>()) {}
+
+WakeSignal::~WakeSignal() = default;
+
+void WakeSignal::signal() noexcept {
+    if (!signalled.exchange(true)) {
+        semaphore->post();
+    }
+}
+
+void WakeSignal::wait() noexcept {
+    semaphore->wait();
+
+    // Cleared once awake, so the next signal posts again - and read-modify-written, so a signal
+    // that found it still set, and didn't post, has what it did before visible here too
+    signalled.exchange(false);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Wakes a thread that waits for work, from any other thread - the audio thread included, as
+// signal() never locks or allocates. juce::Thread::notify() can't be used there, it locks the
+// thread's event. Only the first signal since the waiter last woke touches the semaphore, any
+// more until then are an atomic exchange.
+class WakeSignal final {
+public:
+    WakeSignal();
+    ~WakeSignal();
+
+    // Any thread
+    void signal() noexcept;
+
+    // The one waiting thread - returns once signalled, straight away if it was since the last
+    // wait. Whatever a thread did before signalling is visible to the waiter once it returns.
+    void wait() noexcept;
+
+private:
+    // The platform's semaphore, whose post never takes a lock
+    struct Semaphore;
+    std::unique_ptr<Semaphore> semaphore;
+    std::atomic<bool> signalled {false};
+
+    JUCE_DECLARE_NON_COPYABLE (WakeSignal)
+};